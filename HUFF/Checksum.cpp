@@ -0,0 +1,249 @@
+//==============================================================================================
+// File: Checksum.cpp - CRC32C checksums implementation
+// c.f.: Checksum.h
+//
+// CRC32C uses the Castagnoli polynomial, which x86 processors with SSE4.2 can fold into the
+// checksum 8 bytes at a time with a single instruction. That is far faster than coding the
+// bytes, so checksumming while encoding or decoding costs next to nothing. Other processors
+// fall back to a lookup table, which gives exactly the same checksum, just more slowly.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define CRC32C_HARDWARE
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSE42
+#else
+#include <cpuid.h>
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#endif
+
+#include "Checksum.h"
+
+Crc32c::Crc32c()
+{
+	// The constructor. A CRC starts with every bit on, so leading zeros still change it.
+	//
+	state = 0xFFFFFFFF;
+}
+
+void Crc32c::Update(const char* data, size_t size)
+{
+	// This method adds the given bytes to the checksum, with the crc32 instruction if the
+	// processor has it. We only check once, since the answer can't change while we run.
+	//
+	static const bool hardware = hasHardwareSupport();
+
+	if (hardware)
+	{
+		state = updateHardware(state, (const unsigned char*)data, size);
+	}
+	else
+	{
+		state = updateSoftware(state, (const unsigned char*)data, size);
+	}
+}
+
+unsigned int Crc32c::GetValue() const
+{
+	// This method returns the checksum. Every bit is inverted at the end,
+	// so trailing zeros change the checksum as well.
+	//
+	return state ^ 0xFFFFFFFF;
+}
+
+bool Crc32c::hasHardwareSupport()
+{
+	// This method checks whether the processor has SSE4.2, which is
+	// bit 20 of ecx for cpuid leaf 1.
+	//
+#if defined(CRC32C_HARDWARE) && defined(_MSC_VER)
+	int info[4];
+
+	__cpuid(info, 1);
+
+	return (info[2] & (1 << 20)) != 0;
+#elif defined(CRC32C_HARDWARE)
+	unsigned int eax, ebx, ecx, edx;
+
+	return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) != 0;
+#else
+	return false;
+#endif
+}
+
+#ifdef CRC32C_HARDWARE
+TARGET_SSE42
+#endif
+unsigned int Crc32c::updateHardware(unsigned int state, const unsigned char* data, size_t size)
+{
+	// This method adds the given bytes to the state with the crc32 instruction. We fold in
+	// as many whole words as we can, 8 bytes at a time on 64 bit processors and 4 on 32 bit
+	// ones, then the bytes left over one at a time.
+	//
+#if defined(CRC32C_HARDWARE) && (defined(_M_X64) || defined(__x86_64__))
+	unsigned long long wide = state;
+
+	for (; size >= 8; size -= 8, data += 8)
+	{
+		unsigned long long word;
+
+		memcpy(&word, data, 8); // The bytes may not be lined up for a direct read, so we copy them out.
+
+		wide = _mm_crc32_u64(wide, word);
+	}
+
+	state = (unsigned int)wide;
+#elif defined(CRC32C_HARDWARE)
+	for (; size >= 4; size -= 4, data += 4)
+	{
+		unsigned int word;
+
+		memcpy(&word, data, 4);
+
+		state = _mm_crc32_u32(state, word);
+	}
+#endif
+
+#ifdef CRC32C_HARDWARE
+	for (; size > 0; size--, data++)
+	{
+		state = _mm_crc32_u8(state, *data);
+	}
+
+	return state;
+#else
+	return updateSoftware(state, data, size);
+#endif
+}
+
+unsigned int Crc32c::updateSoftware(unsigned int state, const unsigned char* data, size_t size)
+{
+	// This method adds the given bytes to the state one at a time, using a table of what each
+	// byte value does to the state. The table is built the first time we need it, from the
+	// Castagnoli polynomial with its bits reversed, since the CRC works from the lowest bit up.
+	//
+	static const struct crctable {
+		unsigned int entries[256];
+
+		crctable()
+		{
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int entry = i;
+
+				for (int bit = 0; bit < 8; bit++)
+				{
+					entry = (entry & 1) ? (entry >> 1) ^ 0x82F63B78 : entry >> 1;
+				}
+
+				entries[i] = entry;
+			}
+		}
+	} table;
+
+	for (; size > 0; size--, data++)
+	{
+		state = table.entries[(state ^ *data) & 0xFF] ^ (state >> 8);
+	}
+
+	return state;
+}
+
+ChecksumInputBuffer::ChecksumInputBuffer(streambuf* source) : source(source), buffer(65536)
+{
+	// The constructor. We start with an empty get area, so the first
+	// read fills it from the source in underflow.
+	//
+	setg(buffer.data(), buffer.data(), buffer.data());
+}
+
+unsigned int ChecksumInputBuffer::GetChecksum() const
+{
+	return checksum.GetValue();
+}
+
+ChecksumInputBuffer::int_type ChecksumInputBuffer::underflow()
+{
+	// This method gets called when everything in the get area has been read. We read the
+	// next chunk from the source, add it to the checksum, and make it the get area.
+	//
+	streamsize read = source->sgetn(buffer.data(), buffer.size());
+
+	if (read <= 0) // If the source has run out,
+	{
+		return traits_type::eof(); // so have we.
+	}
+
+	checksum.Update(buffer.data(), (size_t)read);
+
+	setg(buffer.data(), buffer.data(), buffer.data() + read);
+
+	return traits_type::to_int_type(buffer[0]);
+}
+
+ChecksumOutputBuffer::ChecksumOutputBuffer(streambuf* destination) : destination(destination), buffer(65536)
+{
+	// The constructor. The whole buffer is our put area, so
+	// nothing is passed on until it fills up or we are flushed.
+	//
+	setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+unsigned int ChecksumOutputBuffer::GetChecksum() const
+{
+	return checksum.GetValue();
+}
+
+ChecksumOutputBuffer::int_type ChecksumOutputBuffer::overflow(int_type character)
+{
+	// This method gets called when the put area is full. We pass everything in it on,
+	// then put the given character at the beginning of the now empty put area.
+	//
+	if (!passOn())
+	{
+		return traits_type::eof();
+	}
+
+	if (!traits_type::eq_int_type(character, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(character);
+
+		pbump(1);
+	}
+
+	return traits_type::not_eof(character);
+}
+
+int ChecksumOutputBuffer::sync()
+{
+	// This method gets called when the stream is flushed. We pass
+	// everything we have on and flush the destination too.
+	//
+	return passOn() ? destination->pubsync() : -1;
+}
+
+bool ChecksumOutputBuffer::passOn()
+{
+	// This method adds everything in the put area to the checksum and writes
+	// it to the destination, leaving the put area empty.
+	//
+	streamsize count = pptr() - pbase();
+
+	checksum.Update(pbase(), (size_t)count);
+
+	bool written = destination->sputn(pbase(), count) == count;
+
+	setp(buffer.data(), buffer.data() + buffer.size());
+
+	return written;
+}
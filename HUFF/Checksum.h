@@ -0,0 +1,62 @@
+//==============================================================================================
+// File: Checksum.h - CRC32C checksums
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Works out the CRC32C (Castagnoli) checksum of bytes given to it a piece at a time, using the
+// crc32 instruction of SSE4.2 when the processor has it, and a lookup table when it doesn't.
+class Crc32c {
+public:
+	Crc32c();
+
+	void Update(const char* data, size_t size); // Adds the given bytes to the checksum
+	unsigned int GetValue() const; // Returns the checksum of every byte added so far
+private:
+	unsigned int state; // The checksum so far, before the final inversion
+
+	static bool hasHardwareSupport(); // Checks whether the processor has the crc32 instruction
+	static unsigned int updateHardware(unsigned int state, const unsigned char* data, size_t size); // Adds bytes to the state with the crc32 instruction
+	static unsigned int updateSoftware(unsigned int state, const unsigned char* data, size_t size); // Adds bytes to the state with the lookup table
+};
+
+// A read only stream buffer that reads from another stream buffer, working out the checksum
+// of every byte that passes through it, so the input can be checksummed while it is encoded.
+class ChecksumInputBuffer : public streambuf {
+public:
+	ChecksumInputBuffer(streambuf* source); // Makes a stream buffer that reads from the given one
+	unsigned int GetChecksum() const; // Returns the checksum of every byte read from the source so far
+protected:
+	int_type underflow() override; // Reads the next chunk from the source when everything read so far has been used
+private:
+	streambuf* source;		// The stream buffer we read from
+	vector<char> buffer;	// The chunk of the source we are reading from
+	Crc32c checksum;		// The checksum of every chunk read so far
+};
+
+// A write only stream buffer that writes to another stream buffer, working out the checksum
+// of every byte that passes through it, so the output can be checksummed while it is decoded.
+class ChecksumOutputBuffer : public streambuf {
+public:
+	ChecksumOutputBuffer(streambuf* destination); // Makes a stream buffer that writes to the given one
+	unsigned int GetChecksum() const; // Returns the checksum of every byte passed on to the destination so far
+protected:
+	int_type overflow(int_type character) override; // Passes the buffered bytes on when the buffer is full, then buffers the given character
+	int sync() override; // Passes the buffered bytes on and flushes the destination
+private:
+	streambuf* destination;	// The stream buffer we write to
+	vector<char> buffer;	// The bytes written but not passed on yet
+	Crc32c checksum;		// The checksum of every byte passed on so far
+
+	bool passOn(); // Adds the buffered bytes to the checksum and writes them to the destination, returning false if it can't take them
+};
@@ -0,0 +1,330 @@
+//==============================================================================================
+// File: FixedHuffmanCoder.h - Huffman coder specialized for a fixed tree
+//
+// This class template encodes and decodes .huf files for one tree that is known when the
+// program is compiled. The tree comes from a codebook header made from a tree builder file
+// with the -g flag, which holds the codes, the decoding tree and a decoding table as constexpr
+// tables. Since nothing about the tree is worked out at run time, there is no tree to build
+// before the first byte is coded, and the tables live in read only memory. The loops are the
+// same for every tree; what makes decoding fast is the table, which turns the next 8 bits into
+// a whole symbol with one lookup instead of one step down the tree per bit. Just like
+// EncodeFileWithTree, inputs the tree would make bigger are stored as is, so without any options,
+// the files are the same as the ones it writes, and either one can decode the other's files.
+//
+// A codebook is a struct with these members, which needs C++17 for the inline static arrays:
+//   MAX_LENGTH  - the length in bits of the longest code
+//   CODE_BYTES  - the amount of bytes each code is stored in
+//   TABLE_BITS  - the amount of bits the decoding table looks up at once
+//   treeBuilder - the 510 tree builder bytes of the tree
+//   lengths     - the length in bits of the code of each symbol
+//   codes       - the bits of each code, starting at the highest bit of the first byte
+//   children    - the left and right child of each internal node, with the root at 0 and
+//                 leaves stored as LEAF plus their symbol
+//   decodeTable - for every value of the next TABLE_BITS bits, the leaf they start with and
+//                 the length of its code, or the node they lead to and TABLE_BITS if no code
+//                 that short matches
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <cstring>
+#include <string>
+
+#include "Checksum.h"
+#include "HuffmanFormat.h"
+#include "MemoryBuffer.h"
+
+using namespace std;
+
+template <class Codebook>
+class FixedHuffmanCoder {
+public:
+	const static unsigned short LEAF = 256; // Children at or above this are leaves, holding their symbol plus LEAF
+
+	static void EncodeBuffer(const char* data, size_t size, string& output); // Encodes the given bytes into the given string
+	static bool DecodeBuffer(const char* data, size_t size, string& output); // Decodes the given encoded bytes into the given string, returning false if they weren't encoded with this tree
+private:
+	static void writeHeader(unsigned long long originalLength, bool stored, string& output); // Replaces the output with the header of a file of the given length, followed by the tree builder unless the input is stored
+	static bool checksumMatches(const HuffmanFormat::header& fileHeader, const string& output); // Checks the decoded output against the checksum in the header, if it has one
+};
+
+template <class Codebook>
+void FixedHuffmanCoder<Codebook>::EncodeBuffer(const char* data, size_t size, string& output)
+{
+	// This method encodes the given bytes into the given string. Every code is already in the
+	// codebook, so we first add up the lengths of the codes to know exactly how big the output
+	// will be, make room for all of it at once, then write the codes straight into the string.
+	// If the codes and the tree builder wouldn't be smaller than the input, we store it as is,
+	// which is the same rule the Huffman class uses.
+	//
+	const unsigned char* input = (const unsigned char*)data;
+
+	unsigned long long bitCount = 0; // The amount of encoded bits the input will take up
+
+	for (size_t i = 0; i < size; i++)
+	{
+		bitCount += Codebook::lengths[input[i]];
+	}
+
+	if ((bitCount + 7) / 8 + HuffmanFormat::TREE_BUILDER_SIZE >= size) // If coding the input wouldn't make it smaller,
+	{
+		writeHeader(size, true, output); // the file is just the header,
+
+		output.append(data, size); // followed by the input.
+
+		return;
+	}
+
+	writeHeader(size, false, output); // Otherwise, the file starts with the header and the tree builder, just like any other.
+
+	size_t start = output.size(); // The encoded bits go after the tree builder.
+
+	output.resize(start + (size_t)((bitCount + 7) / 8)); // We make room for every byte of them, including the last partly filled one.
+
+	unsigned char* out = (unsigned char*)&output[start];
+
+	unsigned int pendingBits = 0;	// The bits of the next byte we haven't written yet, in the lowest bits
+	int pendingCount = 0;			// The amount of pending bits
+
+	for (size_t i = 0; i < size; i++) // Loop through every byte of the input,
+	{
+		const unsigned char* code = Codebook::codes[input[i]]; // get the code for its symbol,
+
+		int length = Codebook::lengths[input[i]];
+
+		// and add the code to the pending bits a byte at a time. The last byte of a code might only be partly
+		// used, so we shift its bits down from the top of the byte. Whenever we have a whole byte, we write it.
+		for (int j = 0; length > 0; j++, length -= 8)
+		{
+			int count = length < 8 ? length : 8;
+
+			pendingBits = (pendingBits << count) | (code[j] >> (8 - count));
+
+			pendingCount += count;
+
+			if (pendingCount >= 8)
+			{
+				pendingCount -= 8;
+
+				*out++ = (unsigned char)(pendingBits >> pendingCount);
+			}
+		}
+	}
+
+	if (pendingCount > 0) // If there are bits left over, they go at the top of the last byte, with zeros after them.
+	{
+		*out = (unsigned char)(pendingBits << (8 - pendingCount));
+	}
+}
+
+template <class Codebook>
+bool FixedHuffmanCoder<Codebook>::DecodeBuffer(const char* data, size_t size, string& output)
+{
+	// This method decodes the given encoded bytes into the given string. We read the header,
+	// make sure the file was encoded with our tree by comparing its tree builder to ours, then
+	// decode a symbol at a time with the decoding table. We keep up to 64 of the encoded bits
+	// in a buffer, highest first, so the next TABLE_BITS of them can be looked up at once. Most
+	// codes are no longer than that, so the lookup gives us the symbol and how many bits to use
+	// up. For the rest, we use up all of the looked up bits and finish the code one bit at a
+	// time down the decoding tree, from the node the table says they lead to. If the file has
+	// the original length, we stop right after the last symbol. Stored files
+	// don't have a tree at all, so we just copy them. If the file was encoded with a different
+	// tree, is cut off, or doesn't match its checksum, we return false. Files split into blocks
+	// may use a different tree for every block, so we can't decode those either.
+	//
+	output.clear();
+
+	HuffmanFormat::header fileHeader; // The header tells us where the tree builder is and how long the original file was.
+
+	size_t position = 0; // The position of the next byte we read
+
+	if (HuffmanFormat::readHeader(data, size, fileHeader)) // If the file has a header,
+	{
+		if (fileHeader.version == 0 || fileHeader.version > HuffmanFormat::VERSION || (fileHeader.flags & HuffmanFormat::FLAG_BLOCKS)) // but we don't know its version, or it is split into blocks,
+		{
+			return false; // we can't decode it.
+		}
+
+		position = HuffmanFormat::headerSize(fileHeader); // Otherwise, we skip over it.
+	}
+
+	bool lengthKnown = fileHeader.originalLength != HuffmanFormat::UNKNOWN_LENGTH;
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_STORED) // If the input was stored rather than coded,
+	{
+		size_t storedLength = size - position; // everything after the header is the original bytes,
+
+		if (lengthKnown && storedLength < fileHeader.originalLength) // so if there aren't as many as there should be,
+		{
+			return false; // the file is cut off.
+		}
+
+		// Otherwise, we copy them straight through.
+		output.assign(data + position, lengthKnown ? (size_t)fileHeader.originalLength : storedLength);
+
+		return checksumMatches(fileHeader, output);
+	}
+
+	// If the file is too short to have a tree builder, or it isn't ours, we can't decode it.
+	if (size - position < (size_t)HuffmanFormat::TREE_BUILDER_SIZE || memcmp(data + position, Codebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE) != 0)
+	{
+		return false;
+	}
+
+	position += HuffmanFormat::TREE_BUILDER_SIZE;
+
+	size_t dataEnd = size; // Without a seek table, the encoded bits end at the end of the file.
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_SEEK_TABLE) // If there is a seek table, we find out how many entries it has from its footer,
+	{
+		if (size - position < (size_t)HuffmanFormat::SEEK_FOOTER_SIZE)
+		{
+			return false;
+		}
+
+		MemoryInputBuffer footerBuffer(data + size - HuffmanFormat::SEEK_FOOTER_SIZE, HuffmanFormat::SEEK_FOOTER_SIZE);
+
+		istream footer(&footerBuffer);
+
+		HuffmanFormat::readNumber(footer, 4); // skipping over the interval,
+
+		unsigned long long tableSize; // The size of the entries and the footer
+
+		if (!HuffmanFormat::seekTableSize(HuffmanFormat::readNumber(footer, 8), size - position, tableSize)) // If the table would start before the encoded bits, the file is corrupt.
+		{
+			return false;
+		}
+
+		dataEnd = size - (size_t)tableSize; // and the encoded bits end right where the table starts.
+	}
+
+	unsigned long long symbolsLeft = fileHeader.originalLength; // Without the original length, this is so large we decode every bit.
+
+	if (lengthKnown) // If we know how long the original file is,
+	{
+		if (fileHeader.originalLength / 8 > dataEnd - position) // every symbol takes at least one bit, so if there aren't enough bits, the file is cut off.
+		{
+			return false;
+		}
+
+		output.reserve((size_t)fileHeader.originalLength); // Otherwise, we make room for the whole output up front.
+	}
+
+	const unsigned char* input = (const unsigned char*)data;
+
+	unsigned long long bits = 0;	// The encoded bits we've read but not used yet, starting at the highest bit
+	int bitCount = 0;				// The amount of them
+
+	while (symbolsLeft > 0) // Until we have every symbol,
+	{
+		while (bitCount <= 56 && position < dataEnd) // we fill the buffer with whole bytes, as long as there's room for them.
+		{
+			bits |= (unsigned long long)input[position++] << (56 - bitCount);
+
+			bitCount += 8;
+		}
+
+		if (bitCount == 0) // If there are no bits left, we're done.
+		{
+			break;
+		}
+
+		// We look up the next TABLE_BITS bits. If we have fewer than that at the end of the data, the bits after them are zeros.
+		const unsigned short* entry = Codebook::decodeTable[bits >> (64 - Codebook::TABLE_BITS)];
+
+		unsigned short node = entry[0];
+
+		if (entry[1] > bitCount) // If the code needs more bits than are left, the data ends partway through it.
+		{
+			break;
+		}
+
+		bits <<= entry[1]; // We use up the bits we looked up.
+		bitCount -= entry[1];
+
+		while (node < LEAF) // If they don't make a whole code, we follow the bits after them down the tree until they do.
+		{
+			if (bitCount == 0) // If we need another byte,
+			{
+				if (position == dataEnd) // but there aren't any, the data ends partway through the code.
+				{
+					break;
+				}
+
+				bits = (unsigned long long)input[position++] << 56;
+
+				bitCount = 8;
+			}
+
+			node = Codebook::children[node][bits >> 63]; // The highest bit tells us which child to go to.
+
+			bits <<= 1;
+			bitCount--;
+		}
+
+		if (node < LEAF) // If we ran out of bits before the end of the code,
+		{
+			break; // there's no symbol to write.
+		}
+
+		output.push_back((char)(node - LEAF)); // Otherwise, we write the symbol we reached,
+
+		symbolsLeft--; // and count it off. If it was the last one, the rest of the bits are padding.
+	}
+
+	// If we knew how many symbols there were, we should have decoded every one of them.
+	return (!lengthKnown || symbolsLeft == 0) && checksumMatches(fileHeader, output);
+}
+
+template <class Codebook>
+void FixedHuffmanCoder<Codebook>::writeHeader(unsigned long long originalLength, bool stored, string& output)
+{
+	// This method replaces the output with the header of a file of the given length, using
+	// a stream over the string so the header is written exactly the way the Huffman class
+	// writes it. Coded files have the tree builder right after the header, and stored files
+	// have nothing, since the input comes next as is.
+	//
+	HuffmanFormat::header fileHeader;
+
+	fileHeader.version = HuffmanFormat::VERSION;
+	fileHeader.originalLength = originalLength;
+	fileHeader.flags = stored ? HuffmanFormat::FLAG_STORED : 0;
+
+	StringOutputBuffer outputBuffer(output);
+
+	ostream outputStream(&outputBuffer);
+
+	HuffmanFormat::writeHeader(outputStream, fileHeader);
+
+	if (!stored)
+	{
+		outputStream.write((const char*)Codebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE);
+	}
+
+	outputStream.flush();
+
+	outputBuffer.finish(); // We trim the string down to the bytes we wrote, so the rest of the file can go right after them.
+}
+
+template <class Codebook>
+bool FixedHuffmanCoder<Codebook>::checksumMatches(const HuffmanFormat::header& fileHeader, const string& output)
+{
+	// This method checks the whole decoded output against the checksum in the header. Files
+	// without a checksum have nothing to check against, so they always match.
+	//
+	if (!(fileHeader.flags & HuffmanFormat::FLAG_CHECKSUM))
+	{
+		return true;
+	}
+
+	Crc32c checksum;
+
+	checksum.Update(output.data(), output.size());
+
+	return checksum.GetValue() == fileHeader.checksum;
+}
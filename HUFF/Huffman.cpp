@@ -12,31 +12,102 @@
 // Date:       Mar 17, 2020
 // Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "Huffman.h"
+#include "HuffmanDaemon.h"
+#include "HuffmanVerifier.h"
 
-Huffman::Huffman() : nodes{ nullptr }
+Huffman::Huffman() : nodes{ nullptr }, tables(nullptr), inputStream(nullptr), outputStream(nullptr), outputString(nullptr)
 {
-	// The constructor. We just need to intialize all of our member variables:
+	// The constructor. We just need to intialize all of our member variables. Our streams
+	// start out without a stream buffer, since we don't know if we'll be reading and writing
+	// files or memory until an operation begins.
 	//
+	encodingTableBuilt = false; // We haven't built a tree yet, so we haven't built its encoding table either.
+
 	bytesIn = 0;	// Initialize our bytes in to zero, as we haven't read any bytes yet.
 
 	bytesOut = 0;	// Initialize our bytes out to zero as well, as we haven't written any bytes either.
 
+	seekInterval = 0; // By default, we don't write a seek table, so files stay as small as possible.
+
+	checksumEnabled = false; // We don't write a checksum unless we're asked to either,
+
+	verifyEnabled = false; // or check that what we encode decodes,
+
+	sampleSize = 0; // We count every byte of the input to build the tree,
+
+	blockSize = 0; // and use one tree for all of it.
+
 	start = chrono::high_resolution_clock::now(); // We set the starting time position to the current time.
 }
 
 Huffman::~Huffman()
 {
-	// In the destructor, we need to make sure we properly clean up the nodes we had.
-	// To do this, we loop through node in the nodes array.
+	// In the destructor, we need to make sure we properly clean up the nodes we had,
+	// which is exactly what destroyTree does.
+	//
+	destroyTree();
+}
+
+void Huffman::destroyTree()
+{
+	// This method deletes every node of the tree that is currently built, so that a different
+	// tree can be built in its place. To do this, we loop through node in the nodes array.
 	//
 	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
 	{
 		if (nodes[i] != nullptr) // If a node exists at element i in the nodes array...
 		{
 			traverseDestruct(nodes[i]); // We call the traverseDestruct method to take care of the node and its children, recursively.
+
+			nodes[i] = nullptr; // The node is gone, so we make sure we don't point to it anymore.
 		}
 	}
+
+	treeBuilder.clear(); // There is no tree anymore, so it has no tree builder bytes,
+
+	tables = nullptr; // no tables,
+
+	encodingTableBuilt = false; // and the encoding table doesn't match any tree.
+}
+
+void Huffman::beginOperation()
+{
+	// This method gets called at the beginning of every operation. An instance can be used
+	// for more than one operation, so we reset our counters and starting time here instead
+	// of only in the constructor. The tree is kept, since the next operation may use it again.
+	//
+	bytesIn = 0;	// We haven't read any bytes for this operation yet,
+
+	bytesOut = 0;	// or written any.
+
+	seekTable.clear(); // Any seek table entries belong to the last operation,
+
+	verificationError.clear(); // and so does anything we found out verifying it,
+
+	lastError.clear(); // anything that went wrong with it,
+
+	samplingReport.clear(); // or sampling its input,
+
+	blocks.clear(); // and so do its blocks.
+
+	start = chrono::high_resolution_clock::now(); // We set the starting time position to the current time.
 }
 
 void Huffman::traverseDestruct(treenode* p) {
@@ -62,47 +133,64 @@ void Huffman::traverseDestruct(treenode* p) {
 	delete p;
 }
 
-int Huffman::getIndexOfSmallestNode(int skipIndex)
+bool Huffman::buildTreeFromTreeBuilder(istream& stream)
 {
-	// This method returns the index of the smallest node in the array (based on a node's weight).
-	// To do this, we will loop through every node in the nodes array, keeping track of
-	// the index and weight of the smallest node.
-	int smallestNodeIndex = -1; // Set up a variable to keep track of the index of the smallest node
-	unsigned int smallestWeight = UINT_MAX; // Initialize the smallest weight to the maximum unsigned integer.
+	// This method builds the Huffman tree by combining nodes based
+	// on the first 510 bytes of the input stream passed in. If the
+	// tree that is currently built came from the exact same bytes,
+	// we just keep it instead. If we have a table cache with tables
+	// for these bytes, we use them instead of building anything, and
+	// otherwise we add the tables we build to it. If the stream runs
+	// out before we have all 510 bytes, or the bytes don't describe a
+	// valid tree, we return false, leaving no tree built.
+	//
+	string bytes(HuffmanFormat::TREE_BUILDER_SIZE, '\0'); // A string to hold the 510 bytes of the tree builder
 
-	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // Loop through every node in the nodes array
+	stream.read(&bytes[0], HuffmanFormat::TREE_BUILDER_SIZE); // We read all of the tree builder bytes at once.
+
+	if (stream.gcount() != HuffmanFormat::TREE_BUILDER_SIZE) // If the stream didn't have all of them,
 	{
-		if (skipIndex == i) // If i is the index we want to skip,
-		{
-			continue;		// we continue, as we don't want to check the node at this index.
-		}
+		destroyTree(); // we can't build a tree, so we make sure we don't leave one behind,
 
-		treenode* node = nodes[i]; // Get the node pointer at index i of the nodes array
+		return false; // and return false.
+	}
 
-		if (node == nullptr)	// If the node pointer is nullptr, we have no weight to check,
-		{
-			continue;			// so we continue to the next node.
-		}
+	if (tables != nullptr && bytes == treeBuilder) // If we already have a tree built from these bytes,
+	{
+		return true; // it is exactly the tree we would build, so we're done.
+	}
+
+	destroyTree(); // Otherwise, we get rid of the tree we have, if any, before building the new one.
+
+	vector<HuffmanTreeBuilder::merge> merges; // The combinations the bytes describe, one for each pair of bytes
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS - 1; i++)
+	{
+		merges.push_back({ (unsigned char)bytes[2 * i], (unsigned char)bytes[2 * i + 1] });
+	}
+
+	// A tree builder always lists the smaller index first, and both indices have to still have a node,
+	// otherwise the bytes don't describe a tree. We check that before anything else, so whether we
+	// accept the bytes never depends on what happens to be in the table cache.
+	if (!HuffmanTreeBuilder::IsValid(merges, AMOUNT_OF_CHARACTERS))
+	{
+		return false;
+	}
+
+	if (tableCache != nullptr) // If we have a table cache,
+	{
+		const HuffmanTables* cachedTables = tableCache->Find(bytes);
 
-		if (node->weight < smallestWeight)	// If the node's weight is smaller than the smallest weight,
+		if (cachedTables != nullptr) // and somebody already built the tables for this tree,
 		{
-			smallestNodeIndex = i;			// we set the smallest node index to i,
-			smallestWeight = node->weight;	// and we set the smallest weight to the node's weight.
+			tables = cachedTables; // we use them as they are, without building any nodes.
+
+			treeBuilder = bytes;
+
+			return true;
 		}
 	}
 
-	// Since we've checked every node in the array and have the
-	// smallest node index, we can now return it.
-	return smallestNodeIndex;
-}
-
-void Huffman::buildTreeFromTreeBuilder(ifstream& stream, bool writeToOutput)
-{
-	// This method builds the Huffman tree by combining nodes based
-	// on the first 510 bytes of the input stream passed in. If the
-	// write to output parameter is on, the bytes will be written
-	// to the output stream.
-	//
 	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // We want to loop through every index in the nodes array,
 	{
 		treenode* node = new treenode; // construct a new treenode,
@@ -115,19 +203,10 @@ void Huffman::buildTreeFromTreeBuilder(ifstream& stream, bool writeToOutput)
 		nodes[i] = node; // and set the index at i of the nodes array to our newly constructed node.
 	}
 
-	// TODO: WHAT HAPPENS IF WE DON'T HAVE A FILE THIS BIG?
-	for (int i = 0; i < AMOUNT_OF_CHARACTERS - 1; i++) // Since we are combining nodes based on 510 bytes, we do 255 iterations, or 255 combinations.
+	for (const HuffmanTreeBuilder::merge& combination : merges) // Since we are combining nodes based on 510 bytes, we do 255 iterations, or 255 combinations.
 	{
-		unsigned char leftIndex = stream.get();		// We get the character representing the left index of the nodes we are going to combine,
-		unsigned char rightIndex = stream.get();	// and we also get the character representing the right index.
-
-		if (writeToOutput) // If we are writing to the output stream,
-		{
-			outputStream.put(leftIndex);	// we write the left index
-			outputStream.put(rightIndex);	// as well as the right index.
-
-			bytesOut += 2; // Since we've written two characters to the output stream, we need to increment our bytes out by two.
-		}
+		unsigned int leftIndex = combination.left;		// We get the left index of the nodes we are going to combine,
+		unsigned int rightIndex = combination.right;	// and we also get the right index.
 
 		treenode* parent = new treenode; // We construct a new node that will act as the parent of the nodes at the left and right index.
 
@@ -144,23 +223,47 @@ void Huffman::buildTreeFromTreeBuilder(ifstream& stream, bool writeToOutput)
 		nodes[leftIndex] = parent;		// we can set the node at the left index in the nodes array to the parent,
 		nodes[rightIndex] = nullptr;	// and set the right index in the nodes array to nullptr.
 	}
+
+	treeBuilder = bytes; // We remember the bytes we built the tree from, so we can tell if we are asked to build it again.
+
+	buildTables(); // Now that we have the tree, we build the tables we code with,
+
+	if (tableCache != nullptr) // and if we have a table cache,
+	{
+		tableCache->Store(builtTables); // we add them to it, so this tree never has to be built again.
+	}
+
+	return true;
 }
 
 void Huffman::buildTree(bool incrementBytesIn)
 {
 	// This method builds the Huffman tree by determining the frequencies of each character in the input file,
 	// constructing tree nodes for each character, then combining the two smallest nodes until we are left with
-	// one root node.
+	// one root node. The combinations are kept in the tree builder bytes rather than written right away, so
+	// the caller can decide whether the file should be coded at all before writing anything.
 	//
-	// We start by creating an array of unsigned integers that keep track of the amount
-	// of times a character occurs in the input file.
-	unsigned int frequencyTable[AMOUNT_OF_CHARACTERS];
+	destroyTree(); // We start by getting rid of the tree we have, if any, since we are building a new one.
+
+	countFrequencies(incrementBytesIn); // We count how often each character occurs in the input.
+
+	buildTreeFromFrequencies(); // Now that we have the frequencies, we combine the nodes.
+}
 
+void Huffman::countFrequencies(bool incrementBytesIn)
+{
+	// This method reads every byte of the input stream, counting the amount of times each character
+	// occurs and the length of the input. The frequencies build the tree when we make our own, and
+	// tell us what coding the input would cost when we were given the tree instead.
+	//
+	// We start by resetting our frequency table, which keeps track of the amount of times a character occurs in the input file.
 	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // We want to loop through each index of the frequency table array,
 	{
-		frequencyTable[i] = 0; // and initialize its value to 0.
+		frequencies[i] = 0; // and initialize its value to 0.
 	}
 
+	inputLength = 0; // We haven't counted any bytes of the input yet.
+
 	char character; // This variable will hold each character we read from the input stream
 
 	 // While ifstream::get returns a non false value, the next character from the file will be put into our character variable.
@@ -172,7 +275,9 @@ void Huffman::buildTree(bool incrementBytesIn)
 		//
 		unsigned char symbol = character;
 
-		frequencyTable[symbol]++; // We increment the frequency at the index of the symbol by 1. In this case, symbol implicitly is casted into an int.
+		frequencies[symbol]++; // We increment the frequency at the index of the symbol by 1. In this case, symbol implicitly is casted into an int.
+
+		inputLength++; // We count every byte, so the header can say how long the input is.
 
 		if (incrementBytesIn) // If we should increment bytes in,
 		{
@@ -180,464 +285,2507 @@ void Huffman::buildTree(bool incrementBytesIn)
 		}
 	}
 
-	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // We now want to loop through every index of the nodes array.
-	{
-		unsigned char symbol = i;		// We set our symbol to i, which will implicitly cast the int into an unsigned char.
-
-		treenode* node = new treenode;	// We construct a new tree node,
+	countedLength = inputLength; // We counted every byte of the input.
+}
 
-		node->symbol = symbol;			// set its symbol to our symbol from the for loop,
-		node->weight = frequencyTable[symbol]; //set its weight to the frequency of the symbol,
-		node->leftChild = nullptr;  // and set the left child to nullptr,
-		node->rightChild = nullptr; // and the right child to nullptr.
+bool Huffman::buildTreeFromSample()
+{
+	// This method builds the Huffman tree from a sample of the input instead of all of it, so
+	// large inputs only have to be read once more, to encode them, instead of twice. We read
+	// blocks spread evenly across the input, each one at a pseudo random spot within its share
+	// of the input, so data that repeats every so often can't line up with the blocks. The
+	// spots only depend on the length of the input, so the same input always gets the same tree.
+	//
+	// A sample can only stand in for the whole input if the input looks about the same all the
+	// way through. To check, we keep the counts of every other block apart, and compare how many
+	// bits per byte the tree would use on each half of the sample. If they are too far apart, the
+	// input changes along the way, so we count every byte instead. We also estimate how much
+	// worse the tree from the sample should compress than one from a full count, which shrinks
+	// as the sample grows, and count every byte if that would cost too much.
+	//
+	inputLength = getInputLength(); // We won't read all of the input, so we get its length from the stream instead.
 
-		nodes[i] = node; // Now that we've finished building our node, we set the element at index i of the nodes array to our node.
+	if (inputLength / 2 < sampleSize) // If the sample would be a large part of the input anyway,
+	{
+		return false; // it's not worth it, so we count every byte.
 	}
 
-	for (int i = 0; i < AMOUNT_OF_CHARACTERS - 1; i++) // Since we are combining 256 nodes, we need to do 255 iterations.
+	unsigned long long blockCount = sampleSize / SAMPLE_BLOCK_SIZE; // The amount of blocks in the sample,
+
+	if (blockCount < 2)
 	{
-		// We first get the smallest node index, passing -1 as our skip index since we don't want to skip any node.
-		int smallestNodeIndex = getIndexOfSmallestNode(-1);
+		blockCount = 2; // which needs at least two, so it can be split into halves.
+	}
 
-		// Now we get the next smallest node index, passing in our smallest node index so that we skip it.
-		int nextSmallestNodeIndex = getIndexOfSmallestNode(smallestNodeIndex);
+	unsigned long long stride = inputLength / blockCount; // Each block is taken from its own share of the input this long,
 
-		treenode* parent = new treenode; // We now need to construct a parent node that will have these smallest nodes as children.
+	// which leaves this much room to move the block around in, if the share is bigger than the block.
+	unsigned long long slack = stride > SAMPLE_BLOCK_SIZE ? stride - SAMPLE_BLOCK_SIZE : 0;
 
-		treenode* smallestNode = nodes[smallestNodeIndex];			// We get the node at the smallest node index
-		treenode* nextSmallestNode = nodes[nextSmallestNodeIndex];	// and the node at the next smallest node index.
+	unsigned long long halves[2][AMOUNT_OF_CHARACTERS] = {}; // The frequencies counted from every other block of the sample
 
-		parent->symbol = NULL; // In a Huffman tree, a parentnode's symbol doesn't matter, so we set it to NULL.
-		parent->weight = smallestNode->weight + nextSmallestNode->weight; // The parent's weight is the sum of its two childrens' weights.
+	vector<char> block(SAMPLE_BLOCK_SIZE); // The memory we read each block into
 
-		// We always want the node with the smallest index to be the left child,
-		// so we check if the smallest node's index is less than the next smallest
-		// node's index. We also always want the parent node to be put into the
-		// smaller index of the two node indices.
-		//
-		if (smallestNodeIndex < nextSmallestNodeIndex)
-		{
-			parent->leftChild = smallestNode;		// In this case, the left child is the smallest node,
-			parent->rightChild = nextSmallestNode;	// and the right child is the next smallest node.
+	unsigned long long random = inputLength; // The state of the pseudo random numbers that pick each block's spot
 
-			// Since the smallest node's index is smaller than the next smallest node's index, we put the
-			// parent node in that index of the nodes array.
-			nodes[smallestNodeIndex] = parent;
-			nodes[nextSmallestNodeIndex] = nullptr; // We then set the element at the other index to nullptr.
+	for (unsigned long long i = 0; i < blockCount; i++)
+	{
+		random = random * 6364136223846793005ULL + 1442695040888963407ULL; // We step a linear congruential generator,
 
-			// Finally, we write the smallest node index and next smallest node index to the
-			// output stream so that our program can properly rebuild the tree by knowing
-			// which nodes to combine.
-			outputStream.put(smallestNodeIndex);
-			outputStream.put(nextSmallestNodeIndex);
-		}
-		else
-		{
-			parent->leftChild = nextSmallestNode;	// In this case, the left child is the next smallest node,
-			parent->rightChild = smallestNode;		// and the right child is the smallest node.
+		inputStream.clear(); // and start the block somewhere in its share of the input.
+		inputStream.seekg(i * stride + (random >> 33) % (slack + 1));
 
-			// Since the next smallest node's index is smaller than the smallest node's index, we put the
-			// parent node in that index of the nodes array.
-			nodes[nextSmallestNodeIndex] = parent;
-			nodes[smallestNodeIndex] = nullptr; // We then set the element at the other index to nullptr.
+		inputStream.read(block.data(), SAMPLE_BLOCK_SIZE);
 
-			// Finally, we write the next smallest node index and smallest node index to the
-			// output stream so that our program can properly rebuild the tree by knowing
-			// which nodes to combine.
-			outputStream.put(nextSmallestNodeIndex);
-			outputStream.put(smallestNodeIndex);
-		}
+		streamsize read = inputStream.gcount();
 
-		bytesOut += 2; // We increment the bytes out by 2, as we have written two characters to the file.
+		for (streamsize j = 0; j < read; j++) // We count the block into its half of the sample.
+		{
+			halves[i % 2][(unsigned char)block[j]]++;
+		}
 	}
-}
 
-bool Huffman::isLeaf(treenode* node)
-{
-	// This method simply checks if the given node is a leaf,
-	// meaning it has no left or right child.
-	//
-	return node->leftChild == nullptr && node->rightChild == nullptr;
-}
+	inputStream.clear();	// We go back to the beginning of the input stream, so if we end up
+	inputStream.seekg(0);	// counting every byte after all, the count starts at the first one.
 
-void Huffman::buildEncodingTable()
-{
-	// This method builds the encoding table so that each character
-	// in a file will have an encoding string for it inside of the
-	// encoding table array. It is simply a convenience method that
-	// calls the recursive function buildEncodingTable. Unfortunately,
-	// non-static member variables can't be used as default parameters,
-	// so this method is required instead of just having default parameters
-	// of the buildEncodingTable method below.
-	//
-	buildEncodingTable(nodes[0], "");
-}
+	unsigned long long halfLengths[2] = { 0, 0 }; // The amount of bytes in each half of the sample
 
-void Huffman::buildEncodingTable(treenode* node, string path)
-{
-	// This recursive method builds the encoding table for each character
-	// by following the given node's left and right children, building a path
-	// of 0's and 1's on the direction taken to reach a certain leaf node, or
-	// symbol.
-	//
-	if (isLeaf(node)) // If the node is a leaf, we are at a node with a symbol,
+	int symbolsSeen = 0; // The amount of different symbols in the sample
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // The frequencies of the whole sample are the ones of its halves added up.
 	{
-		encodingTable[node->symbol] = path; // so we need to set the encoding bits for the symbol.
+		frequencies[i] = halves[0][i] + halves[1][i];
+
+		halfLengths[0] += halves[0][i];
+		halfLengths[1] += halves[1][i];
 
-		// If the path's length is greater than 7, it can be used as padding bits
-		// if additional bits are needed during encoding for the last byte of a file.
-		if (path.length() > 7)
+		if (frequencies[i] != 0)
 		{
-			paddingBits = path; // Set the padding bits to the path so that it can be used later during encoding
+			symbolsSeen++;
 		}
-
-		return; // Since this node was a leaf, we don't need to check its left or right child, so we just return
 	}
 
-	if (node->leftChild != nullptr) // If the left child of the node isn't null,
+	countedLength = halfLengths[0] + halfLengths[1];
+
+	if (halfLengths[0] == 0 || halfLengths[1] == 0) // If a half of the sample is empty, we have nothing to compare,
 	{
-		// We recursively call this method to build the encoding table for the left child, passing in the given
-		// path + 0, since 0 represents moving to the left child
-		buildEncodingTable(node->leftChild, path + "0");
+		return false; // so we count every byte.
 	}
 
-	if (node->rightChild != nullptr) // If the right child of the node isn't null,
+	buildTreeFromFrequencies(); // We build the tree from the sample,
+
+	double halfBits[2] = { 0, 0 }; // and work out how many bits it would use for each half of it.
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
 	{
-		// We recursively call this method to build the encoding table for the right child, passing in the given
-		// path + 1, since 1 represents moving to the right child
-		buildEncodingTable(node->rightChild, path + "1");
+		halfBits[0] += (double)halves[0][i] * tables->lengths[i];
+		halfBits[1] += (double)halves[1][i] * tables->lengths[i];
 	}
-}
 
-bool Huffman::openStreams(string inputFile, string outputFile)
-{
-	// This method opens the input and output streams for the given input and output
-	// file paths so that the program can read the input file and write to the
-	// output file. If either stream fails to open, the method returns false,
-	// otherwise, true.
-	//
-	// Open the input stream with the input file as the path. We need to open the stream in binary mode,
-	// since we are going to read the file in binary instead of text.
-	inputStream.open(inputFile, ios::binary);
+	double averageBits = (halfBits[0] + halfBits[1]) / countedLength; // The average code length over the whole sample
+
+	// How far apart the average code lengths of the halves are, compared to the average of the whole sample
+	double drift = fabs(halfBits[0] / halfLengths[0] - halfBits[1] / halfLengths[1]) / averageBits;
 
-	if (inputStream.fail()) // If the input stream fails to open,
+	// A distribution of k symbols estimated from n samples is off by about (k - 1) / (2 n ln 2) bits per symbol
+	// on average, so that's about how many more bits per byte the tree from the sample should use.
+	double loss = (symbolsSeen - 1) / (2 * countedLength * log(2.0)) / averageBits;
+
+	if (drift > MAX_SAMPLE_DRIFT) // If the halves of the sample are too different,
 	{
-		cout << "Unable to open input file." << endl; // we print a message saying we couldn't open the input file,
+		samplingReport = "The sample doesn't represent the input, so every byte was counted."; // the input changes along the way.
 
-		return false; // and return false since we failed to open the input stream.
+		return false;
 	}
 
-	// Open the output stream with the output file as the path. We need to open the stream in binary mode,
-	// since we are going to write to the file in binary instead of text.
-	outputStream.open(outputFile, ios::binary);
-
-	if (outputStream.fail()) // If the output stream fails to open,
+	if (loss > MAX_SAMPLE_LOSS) // If the sample is too small for the input,
 	{
-		cout << "Unable to open output file." << endl; // we print a message saying we couldn't open the output file,
+		samplingReport = "The sample is too small for the input, so every byte was counted."; // the tree wouldn't be good enough.
 
-		inputStream.close(); // Since the input stream at this point has been opened, we need to be sure to close it.
-
-		return false; // and return false since we failed to open the output stream.
+		return false;
 	}
 
-	return true; // Since we at this point have opened the input and output streams, we can return true because of success!
-}
+	char lossText[32]; // Otherwise, the tree from the sample is the one we use, so we say how much of the input it was built from.
 
-void Huffman::closeStreams()
-{
-	// This method simply closes the input and output streams as cleanup since we have
-	// finished reading the input file and writing the output file.
-	//
-	inputStream.close(); // Close the input stream
+	snprintf(lossText, sizeof(lossText), "%.3f%%", loss * 100);
+
+	samplingReport = "Built the tree from " + formatUnsignedInt(countedLength) + " of " + formatUnsignedInt(inputLength) + " bytes, for an estimated ratio loss of " + lossText + ".";
 
-	outputStream.close(); // Close the output stream
+	return true;
 }
 
-void Huffman::MakeTreeBuilder(string inputFile, string outputFile)
+void Huffman::buildTreeFromFrequencies()
 {
-	// This method makes a tree builder file at the given output file path from the given input file.
-	// To do this, we have to open our input streams, build our Huffman tree, which will write the bytes 
-	// needed to our output file, then close the streams and print out our final info.
+	// This method builds the Huffman tree from the frequencies we counted, by constructing tree nodes for
+	// each character, then combining the two smallest nodes until we are left with one root node.
 	//
-	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
-	{
-		return; // we return, since we can't do anything.
-	}
+	destroyTree(); // We get rid of the tree we have, if any, since we are building a new one.
 
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // We now want to loop through every index of the nodes array.
+	{
+		unsigned char symbol = i;		// We set our symbol to i, which will implicitly cast the int into an unsigned char.
 
-	// We build the tree. This method will read the bytes of the input file, building a frequency table
-	// and huffman tree. This method will write the bytes needed for the tree builder as it builds the
-	// huffman tree to the output file. Since we want to increment the bytes in here, we pass in true.
-	buildTree(true);
+		treenode* node = new treenode;	// We construct a new tree node,
 
-	closeStreams(); // We've finished building the tree builder file so we close our input and output streams.
+		node->symbol = symbol;			// set its symbol to our symbol from the for loop,
+		node->weight = frequencies[symbol]; //set its weight to the frequency of the symbol,
+		node->leftChild = nullptr;  // and set the left child to nullptr,
+		node->rightChild = nullptr; // and the right child to nullptr.
 
-	printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
-}
+		nodes[i] = node; // Now that we've finished building our node, we set the element at index i of the nodes array to our node.
+	}
 
-void Huffman::navigateTree(unsigned char byte, int bitToCheck, treenode*& node)
-{
-	// This method navigates to a child of the given node by checking if the given bit
-	// is flipped on in the given byte. This is used during the decoding process to
-	// find characters to write to the ouput file. Something important to note is the
-	// use of a node pointer reference - the reason we are using this is so that we can
-	// change the node pointer to point to a different node and have it properly update
-	// for the caller of this method.
-	//
-	// First, we do a bitwise AND of the given byte and bit we are checking. If the result is a non-zero value,
-	// it means that the specific bit of the byte was turned on, or 1, so we navigate to the right child. Otherwise,
-	// we navigate to the left child.
-	node = byte & bitToCheck ? node->rightChild : node->leftChild;
+	// We work out which nodes to combine with a heap, which picks the two smallest nodes the same way
+	// searching the whole nodes array would, breaking ties by the smaller index, just a lot faster.
+	vector<HuffmanTreeBuilder::merge> merges = HuffmanTreeBuilder::Build(frequencies, AMOUNT_OF_CHARACTERS);
 
-	if (isLeaf(node)) // If the node is a leaf, it will have a valid symbol,
+	for (const HuffmanTreeBuilder::merge& combination : merges) // For each combination, in order,
 	{
-		outputStream.put(node->symbol); // so we write it to the output stream,
+		treenode* parent = new treenode; // we construct a parent node that will have the two nodes as children.
 
-		bytesOut++; // increment our bytes out counter since we just wrote a byte,
+		treenode* leftNode = nodes[combination.left];	// The node at the smaller index is always the left child,
+		treenode* rightNode = nodes[combination.right];	// and the node at the larger index is the right child.
+
+		parent->symbol = NULL; // In a Huffman tree, a parentnode's symbol doesn't matter, so we set it to NULL.
+		parent->weight = leftNode->weight + rightNode->weight; // The parent's weight is the sum of its two childrens' weights.
 
-		node = nodes[0]; // and reset the node pointer reference back to the head of the tree for future calls.
+		parent->leftChild = leftNode;
+		parent->rightChild = rightNode;
+
+		// The parent node goes into the smaller index of the two, and the other index is left empty.
+		nodes[combination.left] = parent;
+		nodes[combination.right] = nullptr;
+
+		// Finally, we add both indices to the tree builder bytes so that our program can properly
+		// rebuild the tree by knowing which nodes to combine.
+		treeBuilder.push_back((char)combination.left);
+		treeBuilder.push_back((char)combination.right);
 	}
+
+	buildTables(); // Now that we have the tree, we build the tables we code with.
 }
 
-void Huffman::decodeBytes()
+void Huffman::countBlocks()
 {
-	// This method decodes all of the bytes of the input stream. We do this
-	// by reading in each byte of the input stream, and navigate the Huffman
-	// tree repeatedly until we reach a leaf node, then write the node's symbol
-	// to the output stream. We then start back at the root of the Huffman tree
-	// and continue until we are out of bytes.
+	// This method splits the input into blocks of the block size, the last one being whatever
+	// is left, and counts the frequencies of each one, working out exactly how many bits it
+	// would take up with a tree of its own. The blocks don't depend on each other, so we start
+	// as many counting threads as the processor has threads, once for the whole input, and
+	// they count blocks while we read the next ones. We only have one more buffer than there
+	// are threads, so if reading gets ahead of counting, it waits for a buffer to be free. The
+	// frequencies of the whole input are the ones of its blocks added up, which the shared tree
+	// is built from.
 	//
-	char character; // This variable will hold each character we read from the input stream.
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // We reset our frequency table, since we're counting the input again.
+	{
+		frequencies[i] = 0;
+	}
 
-	 // We set a variable for the current node at the 0th element of our nodes array,
-	// since by this point, we will have built our Huffman tree and its root will always
-	// be at nodes[0]. We use this pointer to navigate the Huffman tree, finding leaf
-	// nodes so that we can write their symbols to the file.
-	treenode* currentNode = nodes[0];
+	inputLength = 0; // We haven't counted any bytes of the input yet.
 
-	while (inputStream.get(character)) // While the input stream successfully reads in a character,
-	{
-		bytesIn++; // We increment our bytes in counter since we have read a byte.
+	unsigned long long remaining = getInputLength(); // The amount of bytes of the input we haven't read into a block
 
-		// We are using our character as a an 8-bit byte with a value of 0 to 255, so we implicitly
-		// cast it into a unsigned char.
-		unsigned char byte = character;
+	// Every block gets its counts up front, so the counting threads can fill them in while we add more blocks.
+	blockCounts.assign((size_t)((remaining + blockSize - 1) / blockSize), blockcounts());
 
-		// An interesting thing to note is that I had tested writing this in a different way. I made a
-		// member variables that was an int array with the powers of 2, from 1 to 128, and I would loop
-		// through each power and I inlined the navigateTree method in the for loop. Somehow, that performed
-		// worse (although only very slightly) than having a navigateTree method and calling it 8 times,
-		// so I stuck with this method, even though there are quite a bit of repeated lines.
-		navigateTree(byte, 128, currentNode); // Use the navigateTree method to go to the correct node's child based on the first bit from the left
-		navigateTree(byte, 64, currentNode); // Use the navigateTree method to go to the correct node's child based on the second bit
-		navigateTree(byte, 32, currentNode); // Use the navigateTree method to go to the correct node's child based on the third bit
-		navigateTree(byte, 16, currentNode); // Use the navigateTree method to go to the correct node's child based on the fourth bit
-		navigateTree(byte, 8, currentNode); // Use the navigateTree method to go to the correct node's child based on the fifth bit
-		navigateTree(byte, 4, currentNode); // Use the navigateTree method to go to the correct node's child based on the sixth bit
-		navigateTree(byte, 2, currentNode); // Use the navigateTree method to go to the correct node's child based on the seventh bit
-		navigateTree(byte, 1, currentNode); // Use the navigateTree method to go to the correct node's child based on the eighth bit
+	unsigned int threadCount = thread::hardware_concurrency(); // The amount of blocks we count at a time
+
+	if (threadCount == 0) // If the amount of threads can't be found out,
+	{
+		threadCount = 1; // we count one block at a time.
 	}
-}
 
-void Huffman::encodeBits(unsigned char& outputCharacter, int& currentBit, string& bits)
-{
-	// This method encodes the given string of bits into the output character.
-	// The given currentBit keeps track of which bit we are changing in the
-	// output character. Once we hit 8, we write to the output file, reset
-	// our outputCharacter and currentBit, and continue.
-	//
-	for (unsigned int i = 0; i < bits.length(); i++) // Loop through every character of the bits string
+	countingqueue queue; // The blocks we've read, which the counting threads take from
+
+	queue.buffers.resize(threadCount + 1); // Every thread can count a block while we read one more.
+	queue.lengths.resize(threadCount + 1);
+
+	for (size_t i = 0; i < queue.buffers.size(); i++) // Every buffer starts out free.
 	{
-		// If the character at index i is equal to '1', it means that we need to encode a 1 at the current bit.
-		// Otherwise, we will be encoding a 0 for off.
-		bool on = bits[i] == '1';
+		queue.freeBuffers.push(i);
+	}
 
-		// Here, we are building the output character or byte bit by bit. To turn on a specific bit of of a byte,
-		// we just need to use a bitwise OR operator with it and another byte that just has one bit turned on,
-		// like 0000 1000, for example. Since we are using currentBit to represent the bit we are on, beginning from
-		// the left, we can use it to determine which bit we will be changing. First, we use the bitwise OR equal
-		// operator. We then take our boolean on, which is either true or false, which in, and use the shift
-		// left operator to shift its value of 1 or 0 to the left a certain number of times to represent the
-		// bit we are changing. Our boolean ends up getting implicitly casted as an integer when using this shift
-		// operator. If on is true and currentBit is 0 for example, we would start with the byte 0000 0001, and
-		// then shift it to the left 7 - 0 times, resulting in 1000 0000. Now we bitwise OR it with our output
-		// character and put the result in our output character variable, successfully flipping a bit in our
-		// output character.
-		outputCharacter |= (on << (7 - currentBit));
+	vector<thread> counters; // The threads that count the blocks
 
-		currentBit++; // We now increment the currentBit so that we can take care of the next bit inside of our output character.
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		counters.push_back(thread(countingLoop, ref(queue), ref(blockCounts)));
+	}
+
+	while (remaining > 0 && blocks.size() < blockCounts.size())
+	{
+		size_t buffer; // The buffer we read the next block into
 
-		if (currentBit == 8) // If the current bit is 8, we have taken care of all bits inside of the output character.
 		{
-			outputStream.put(outputCharacter); // Since we've finished this character, we write it to the output stream,
+			unique_lock<mutex> lock(queue.queueMutex);
 
-			bytesOut++; // increment our bytes out by 1 since we've written a byte,
+			queue.changed.wait(lock, [&queue] { return !queue.freeBuffers.empty(); }); // We wait for a buffer to be free,
 
-			outputCharacter = 0; // reset our output character back to 0,
+			buffer = queue.freeBuffers.front();
 
-			currentBit = 0; // and reset the current bit back to 0.
+			queue.freeBuffers.pop();
+		}
+
+		size_t length = (size_t)(remaining < blockSize ? remaining : blockSize);
+
+		if (queue.buffers[buffer].size() < length) // which is only made as big as it needs to be.
+		{
+			queue.buffers[buffer].resize(length);
+		}
+
+		inputStream.read(queue.buffers[buffer].data(), length); // Reading doesn't need the lock, since only we use a buffer that isn't ready.
+
+		block current;
+
+		current.length = inputStream.gcount(); // If the input turns out to be shorter than it said, the block is only what we got.
+
+		remaining = current.length == length ? remaining - length : 0;
+
+		if (current.length == 0) // If there was nothing left to read after all, we're done.
+		{
+			break;
+		}
+
+		inputLength += current.length;
+
+		{
+			lock_guard<mutex> lock(queue.queueMutex);
+
+			queue.lengths[buffer] = (size_t)current.length;
+
+			queue.ready.push(make_pair(buffer, blocks.size())); // Then we hand the block to the counting threads.
+		}
+
+		queue.changed.notify_all();
+
+		blocks.push_back(current);
+	}
+
+	{
+		lock_guard<mutex> lock(queue.queueMutex);
+
+		queue.finished = true; // Once every block has been read, the threads stop when they run out of blocks to count,
+	}
+
+	queue.changed.notify_all();
+
+	for (thread& counter : counters) // and we wait for all of them to finish.
+	{
+		counter.join();
+	}
+
+	blockCounts.resize(blocks.size()); // If the input was shorter than it said, it has fewer blocks.
+
+	for (const blockcounts& counts : blockCounts) // We add the blocks up to get the whole input.
+	{
+		for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
+		{
+			frequencies[i] += counts.frequencies[i];
 		}
 	}
+
+	countedLength = inputLength; // We counted every byte of the input.
+
+	inputStream.clear();	// We read the input stream, so we go back
+	inputStream.seekg(0);	// to the beginning of it to read it again.
 }
 
-void Huffman::encodeBytes()
+void Huffman::countingLoop(countingqueue& queue, vector<blockcounts>& counts)
 {
-	// This method encodes each character of the input stream by finding its encoding bits
-	// in the encoding table and writes them out to the output stream as bytes are formed from
-	// each set of 8 bits.
+	// This method runs on each counting thread. It takes the next block that has been read,
+	// counts it, and frees its buffer so another block can be read into it, until every block
+	// has been read and there are none left to count. A block's counts are only ever touched
+	// by the thread counting it, so only the queue needs the lock.
 	//
-	// By this point, we may have read every byte of the file for our generation of our Huffman tree,
-	// so we need to reset the input stream so we can read the input file again.
-	inputStream.clear();	// We clear the internal error state flags of the input stream,
-	inputStream.seekg(0);	// and we set the position in the input sequence to 0, or the beginning of the file.
+	while (true)
+	{
+		pair<size_t, size_t> job; // The buffer and index of the block we count next
 
-	char character; // This variable will hold each character we read from the input stream
+		{
+			unique_lock<mutex> lock(queue.queueMutex);
 
-	unsigned char outputCharacter = 0; // This character will hold the byte we will be writing out to the output stream.
+			queue.changed.wait(lock, [&queue] { return !queue.ready.empty() || queue.finished; });
 
-	int currentBit = 0; // The current bit we are changing in the output character
+			if (queue.ready.empty()) // If there are no blocks to count and none are coming,
+			{
+				return; // we're done.
+			}
+
+			job = queue.ready.front();
+
+			queue.ready.pop();
+		}
+
+		countBlock(queue.buffers[job.first].data(), queue.lengths[job.first], counts[job.second]);
 
-	while (inputStream.get(character)) // While the input stream successfully reads in a character, we will encode the character's bits.
+		{
+			lock_guard<mutex> lock(queue.queueMutex);
+
+			queue.freeBuffers.push(job.first); // The buffer can be read into again.
+		}
+
+		queue.changed.notify_all();
+	}
+}
+
+void Huffman::countBlock(const char* data, size_t length, blockcounts& target)
+{
+	// This method counts the frequencies of the given block, which starts at the given data, and
+	// works out how many bits it would take up with a tree of its own. We don't need any nodes for
+	// the tree: the heap tells us which nodes get combined, and from that the length of each code,
+	// which is all we need to know how many bits the block would take up.
+	//
+	for (size_t i = 0; i < length; i++)
 	{
-		// By coercing the character into an unsigned char, we solve the issue with invalid array indexing - normally,
-		// a char will range from -128 to 127, so without this, we may access the array at index -127 to -1!
-		// By casting it to a unsigned char, it's value will range from 0 to 255, fixing any possible indexing issues.
-		//
-		unsigned char symbol = character;
+		target.frequencies[(unsigned char)data[i]]++;
+	}
 
-		string& bitString = encodingTable[symbol]; // We get the bit string for encoding the symbol we read from the file.
+	vector<unsigned int> lengths = HuffmanTreeBuilder::CodeLengths(buildBlockTree(target), AMOUNT_OF_CHARACTERS);
 
-		encodeBits(outputCharacter, currentBit, bitString); // We encode the bits of the symbol into our output character.
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // The block takes up the length of each symbol's code times the amount of times it appears.
+	{
+		target.newTreeBits += (unsigned long long)target.frequencies[i] * lengths[i];
+	}
+}
 
-		bytesIn++; // We increment the bytes in by one, since we have read another byte of the file.
+vector<HuffmanTreeBuilder::merge> Huffman::buildBlockTree(const blockcounts& counts)
+{
+	// This method returns the combinations that build the own tree of a block. It's used once
+	// while counting, to know how many bits the tree would save, and again while planning for
+	// the blocks that turn out to bring it, so we never have to keep a tree for every block.
+	//
+	unsigned long long weights[AMOUNT_OF_CHARACTERS]; // The tree builder takes weights as wide as any input could need.
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
+	{
+		weights[i] = counts.frequencies[i];
 	}
 
-	// At this point, we may be in the middle of an output character, and we don't to forget to write some
-	// bits to our file. To finish off the byte, we need to write some padding bits that won't inadvertently
-	// be a valid character. Since we've already set our padding bits member variable, we can just encode
-	// those bits and our file will be taken care of.
-	if (currentBit != 0)
+	return HuffmanTreeBuilder::Build(weights, AMOUNT_OF_CHARACTERS);
+}
+
+bool Huffman::planBlocks()
+{
+	// This method chooses how each block will be stored. We know the frequencies of every block
+	// and the length of every code of each tree it could use, so we can work out exactly how many
+	// bytes each choice would take up, instead of guessing. A block can be stored as is, coded
+	// with the shared tree, which is the tree that is currently built, coded with the tree of the
+	// last block that brought its own, or coded with a new tree of its own, which costs the 510
+	// bytes of its tree builder on top of its bits. We pick whichever is smallest, preferring the
+	// choices that come first when there's a tie, since they're cheaper to decode. Then we add up
+	// the whole file. If the input looks the same all the way through, every block just uses the
+	// shared tree, and the block headers only make the file bigger, so if coding the whole input
+	// with the shared tree is no bigger, we forget the blocks and do that instead. We return
+	// false if storing the whole input as is would be smaller than either.
+	//
+	// Only the blocks that bring their own tree need it, so we build it again for them here,
+	// keeping its tree builder to write and its code lengths for the blocks after it. Once every
+	// block is planned, we don't need the counts anymore, so we let them go.
+	//
+	vector<unsigned int> previousLengths; // The code lengths of the last block that brought its own tree, if any
+
+	// The block size and the shared tree builder come before the first block.
+	unsigned long long total = HuffmanFormat::BLOCK_SIZE_LENGTH + HuffmanFormat::TREE_BUILDER_SIZE;
+
+	unsigned long long wholeBits = 0; // The amount of bits the whole input takes up with the shared tree
+
+	for (size_t b = 0; b < blocks.size(); b++)
 	{
-		int currentBitInBitString = 0;
+		block& current = blocks[b];
+
+		const blockcounts& counts = blockCounts[b];
 
-		while (currentBit != 8)
+		unsigned long long sharedBits = 0;		// The amount of bits the block takes up with the shared tree,
+		unsigned long long previousBits = 0;	// and with the tree of the last block that brought its own.
+
+		for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
 		{
-			bool on = paddingBits[currentBitInBitString] == '1';
+			sharedBits += (unsigned long long)counts.frequencies[i] * tables->lengths[i];
+
+			if (!previousLengths.empty())
+			{
+				previousBits += (unsigned long long)counts.frequencies[i] * previousLengths[i];
+			}
+		}
+
+		wholeBits += sharedBits;
 
-			outputCharacter |= (on << (7 - currentBit));
+		current.mode = HuffmanFormat::BLOCK_STORED; // We start off storing the block as is,
+		current.dataLength = current.length;
 
-			currentBit++;
-			currentBitInBitString++;
+		unsigned long long cost = current.length; // which takes up exactly as many bytes as it has.
+
+		if ((sharedBits + 7) / 8 < cost) // If the shared tree is smaller, we use it instead.
+		{
+			current.mode = HuffmanFormat::BLOCK_SHARED_TREE;
+			current.dataLength = (sharedBits + 7) / 8;
+
+			cost = current.dataLength;
 		}
 
-		outputStream.put(outputCharacter); // Since we've finished this character, we write it to the output stream,
+		if (!previousLengths.empty() && (previousBits + 7) / 8 < cost) // If the previous tree is smaller yet, we use it instead.
+		{
+			current.mode = HuffmanFormat::BLOCK_PREVIOUS_TREE;
+			current.dataLength = (previousBits + 7) / 8;
 
-		bytesOut++; // increment our bytes out by 1 since we've written a byte,
+			cost = current.dataLength;
+		}
+
+		if (HuffmanFormat::TREE_BUILDER_SIZE + (counts.newTreeBits + 7) / 8 < cost) // If a new tree is smaller even with its tree builder,
+		{
+			current.mode = HuffmanFormat::BLOCK_NEW_TREE; // we use that,
+			current.dataLength = (counts.newTreeBits + 7) / 8;
+
+			cost = HuffmanFormat::TREE_BUILDER_SIZE + current.dataLength;
+
+			vector<HuffmanTreeBuilder::merge> merges = buildBlockTree(counts);
+
+			for (const HuffmanTreeBuilder::merge& combination : merges) // The tree builder bytes are the indices of each combination, in order.
+			{
+				current.treeBuilder.push_back((char)combination.left);
+				current.treeBuilder.push_back((char)combination.right);
+			}
+
+			previousLengths = HuffmanTreeBuilder::CodeLengths(merges, AMOUNT_OF_CHARACTERS); // and it becomes the previous tree of the blocks after it.
+		}
+
+		total += HuffmanFormat::BLOCK_HEADER_SIZE + cost; // Every block also has its header.
+	}
+
+	vector<blockcounts>().swap(blockCounts); // We're done with the counts, so we give their memory back.
+
+	unsigned long long wholeTotal = HuffmanFormat::TREE_BUILDER_SIZE + (wholeBits + 7) / 8; // Without blocks, there's just the tree builder and the bits.
+
+	if (wholeTotal <= total) // If the blocks don't pay off,
+	{
+		blocks.clear(); // we code the whole input with the shared tree.
+
+		total = wholeTotal;
 	}
+
+	return total < inputLength;
 }
 
-void Huffman::EncodeFile(string inputFile, string outputFile)
+bool Huffman::isLeaf(treenode* node)
 {
-	// This method encodes the given input file into the given output file.
-	// To do this, we open the streams, build a Huffman tree from the input file,
-	// build our encoding table for each character, and encode the bytes. We then
-	// finish up by closing the streams and printing our final info.
+	// This method simply checks if the given node is a leaf,
+	// meaning it has no left or right child.
 	//
-	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
+	return node->leftChild == nullptr && node->rightChild == nullptr;
+}
+
+void Huffman::buildTables()
+{
+	// This method builds the tables we code with from the tree of nodes that was just built.
+	// The encoding table is built by calling the recursive function buildEncodingTable.
+	// Unfortunately, non-static member variables can't be used as default parameters, so
+	// this method is required instead of just having default parameters of the
+	// buildEncodingTable method below. We then pack the codes into bytes and number the
+	// internal nodes, so the tables can be used without the nodes, or kept in a table cache.
+	//
+	buildEncodingTable(nodes[0], "");
+
+	encodingTableBuilt = true;
+
+	memcpy(builtTables.magic, HuffmanTableCache::MAGIC, sizeof(builtTables.magic)); // The tables can be written to a cache file as is,
+	builtTables.byteOrder = HuffmanTableCache::BYTE_ORDER_MARK; // so we fill out the fields that describe them.
+	builtTables.version = HuffmanTableCache::VERSION;
+
+	memcpy(builtTables.treeBuilder, treeBuilder.data(), HuffmanFormat::TREE_BUILDER_SIZE);
+
+	memset(builtTables.codes, 0, sizeof(builtTables.codes)); // Every bit of the codes starts off, so we only have to turn on the 1's.
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // For every symbol,
 	{
-		return; // we return, since we can't do anything.
+		builtTables.lengths[i] = (unsigned char)encodingTable[i].length(); // we keep the length of its code,
+
+		for (unsigned int j = 0; j < encodingTable[i].length(); j++) // and turn on the bit for each 1 of the code, starting at the highest bit.
+		{
+			if (encodingTable[i][j] == '1')
+			{
+				builtTables.codes[i][j / 8] |= 128 >> (j % 8);
+			}
+		}
 	}
 
-	// We build the tree. This method will read the bytes of the input file, building a frequency table
-	// and huffman tree. This method will write the bytes needed for the tree builder as it builds the
-	// huffman tree to the output file. Since we don't want to increment the bytes here, we pass in
-	// false.
-	buildTree(false);
+	unsigned short nextIndex = 0; // The root gets the first row of the decoding table.
 
-	buildEncodingTable(); // We build the encoding table so we can encode each character of the input file.
+	buildDecodingTable(nodes[0], nextIndex);
 
-	encodeBytes(); // Now we encode each byte of the input stream.
+	tables = &builtTables; // We code with the tables we just built.
+}
 
-	closeStreams(); // We've finished encoding each byte of the file, so we close our input and output streams.
+void Huffman::buildEncodingTable()
+{
+	// This method builds the encoding table so that each character
+	// in a file will have an encoding string for it inside of the
+	// encoding table array. If the tables came from a table cache,
+	// there are no nodes to follow, so we unpack the strings from
+	// the codes in the tables. If the encoding table has already
+	// been built for the current tree, we don't build it again.
+	//
+	if (encodingTableBuilt)
+	{
+		return;
+	}
 
-	printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++) // For every symbol,
+	{
+		encodingTable[i].assign(tables->lengths[i], '0'); // we start with a code of all 0's,
+
+		for (int j = 0; j < tables->lengths[i]; j++) // and put a 1 in for every bit that is on.
+		{
+			if (tables->codes[i][j / 8] & (128 >> (j % 8)))
+			{
+				encodingTable[i][j] = '1';
+			}
+		}
+	}
+
+	encodingTableBuilt = true;
 }
 
-void Huffman::DecodeFile(string inputFile, string outputFile)
+void Huffman::buildEncodingTable(treenode* node, string path)
 {
-	// This method decodes the given input file into the given output file.
-	// To do this, we open the streams, build a Huffman tree from the tree builder
-	// in the input file, which is the first 510 bytes of the input file. We then
-	// decode the remaining bytes of the input file. We then finish up by closing
-	// the streams and printing our final info.
+	// This recursive method builds the encoding table for each character
+	// by following the given node's left and right children, building a path
+	// of 0's and 1's on the direction taken to reach a certain leaf node, or
+	// symbol.
+	//
+	if (isLeaf(node)) // If the node is a leaf, we are at a node with a symbol,
+	{
+		encodingTable[node->symbol] = path; // so we need to set the encoding bits for the symbol.
+
+		return; // Since this node was a leaf, we don't need to check its left or right child, so we just return
+	}
+
+	if (node->leftChild != nullptr) // If the left child of the node isn't null,
+	{
+		// We recursively call this method to build the encoding table for the left child, passing in the given
+		// path + 0, since 0 represents moving to the left child
+		buildEncodingTable(node->leftChild, path + "0");
+	}
+
+	if (node->rightChild != nullptr) // If the right child of the node isn't null,
+	{
+		// We recursively call this method to build the encoding table for the right child, passing in the given
+		// path + 1, since 1 represents moving to the right child
+		buildEncodingTable(node->rightChild, path + "1");
+	}
+}
+
+bool Huffman::openStreams(string inputFile, string outputFile)
+{
+	// This method opens the input and output streams for the given input and output
+	// file paths so that the program can read the input file and write to the
+	// output file. If either stream fails to open, the method returns false,
+	// otherwise, true.
+	//
+	// Open the input file buffer with the input file as the path. We need to open it in binary mode,
+	// since we are going to read the file in binary instead of text.
+	if (inputFileBuffer.open(inputFile, ios::in | ios::binary) == nullptr) // If the input file fails to open,
+	{
+		reportError("Unable to open input file."); // we print a message saying we couldn't open the input file,
+
+		return false; // and return false since we failed to open the input stream.
+	}
+
+	// Open the output file buffer with the output file as the path. We need to open it in binary mode,
+	// since we are going to write to the file in binary instead of text.
+	if (outputFileBuffer.open(outputFile, ios::out | ios::trunc | ios::binary) == nullptr) // If the output file fails to open,
+	{
+		reportError("Unable to open output file."); // we print a message saying we couldn't open the output file,
+
+		inputFileBuffer.close(); // Since the input file at this point has been opened, we need to be sure to close it.
+
+		return false; // and return false since we failed to open the output stream.
+	}
+
+	attachStreams(&inputFileBuffer, &outputFileBuffer); // Both files are open, so we point our streams at them.
+
+	outputPath = outputFile; // We remember where the output file is, so we can make room for it before decoding.
+
+	return true; // Since we at this point have opened the input and output streams, we can return true because of success!
+}
+
+void Huffman::attachStreams(streambuf* input, streambuf* output)
+{
+	// This method points the input and output streams at the given stream buffers, which
+	// can either be our file buffers or buffers over memory. Changing the stream buffer
+	// also clears any error flags left over from the last operation.
+	//
+	inputStream.rdbuf(input); // Read from the given input buffer,
+
+	outputStream.rdbuf(output); // and write to the given output buffer.
+}
+
+void Huffman::closeStreams()
+{
+	// This method simply closes the input and output streams as cleanup since we have
+	// finished reading the input file and writing the output file.
+	//
+	outputStream.flush(); // Make sure everything we've written has made it to the output buffer.
+
+	inputFileBuffer.close(); // Close the input file, if we had one open
+
+	outputFileBuffer.close(); // Close the output file, if we had one open
+
+	attachStreams(nullptr, nullptr); // Our streams don't have anything to read from or write to anymore.
+
+	outputPath.clear(); // We aren't writing to a file anymore,
+
+	outputString = nullptr; // or a string.
+}
+
+void Huffman::reportError(const string& message)
+{
+	// This method records why the operation failed, so GetError can return it. When the
+	// output is a file, there is a user watching, so we print it out for them as well.
+	// When it is memory, we are being used by another program, like the daemon, which
+	// decides for itself what to do with the message, so we keep quiet.
+	//
+	lastError = message;
+
+	if (outputString == nullptr)
+	{
+		cout << message << endl;
+	}
+}
+
+void Huffman::MakeTreeBuilder(string inputFile, string outputFile)
+{
+	// This method makes a tree builder file at the given output file path from the given input file.
+	// To do this, we have to open our input streams, build our Huffman tree, write its tree builder bytes
+	// to our output file, then close the streams and print out our final info.
 	//
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
 	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
 	{
 		return; // we return, since we can't do anything.
 	}
 
-	// We build the tree from the tree builder in the first 510 bytes of the input file.
-	// This method will read the first 510 bytes of the input file, building a huffman tree,
-	// that we will use to decode the file.
-	buildTreeFromTreeBuilder(inputStream, false);
 
-	// We need to add 510 bytes to the bytes we've read in, since we read the first 510 bytes.
-	// The buildTreeFromTreeBuilder method does not do this, so I'm just doing it here instead.
-	bytesIn += 510;
+	// We build the tree. This method will read the bytes of the input file, building a frequency table
+	// and huffman tree, keeping the bytes needed for the tree builder as it builds the huffman tree.
+	// Since we want to increment the bytes in here, we pass in true.
+	buildTree(true);
 
-	decodeBytes(); // Now, we decode each remaining byte of the input stream.
+	writeTreeBuilder(); // We write the tree builder bytes to the output file.
 
-	closeStreams(); // We've finished decoding each byte of the file, so we close our input and output streams.
+	closeStreams(); // We've finished building the tree builder file so we close our input and output streams.
 
 	printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
 }
 
-void Huffman::EncodeFileWithTree(string inputFile, string TreeFile, string outputFile)
+void Huffman::MakeCodebookHeader(string treeFile, string outputFile, string name)
 {
-	// This method encodes the given input file into the given output file, but
-	// uses the given tree file to build the Huffman tree. To do this, we open the streams,
-	// build a Huffman tree from the tree file, build our encoding table for each character,
-	// and encode the bytes. We then finish up by closing the streams and printing our final info.
+	// This method makes a C++ header at the given output file path from the given tree builder file.
+	// The header has a struct with the given name holding the tree builder bytes, the code of every
+	// symbol, a decoding tree and a decoding table for the first 8 bits of a code as constexpr arrays,
+	// for use with FixedHuffmanCoder. To do this, we build the tree and the encoding table just like
+	// we would to encode a file, then write out both, and work out the decoding table from the tree.
 	//
-	// If we don't open the tree stream first and make sure its valid, we will accidentally create
-	// an empty output file on failure of opening the tree stream file.
-	ifstream treeStream; // We declare another ifstream so we can read our tree file.
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
 
-	// Open the tree stream with the tree file as the path. We need to open the stream in binary mode,
-	// since we are going to read the file in binary instead of text.
-	treeStream.open(TreeFile, ios::binary);
+	// The name becomes the name of a struct, so it has to be a valid identifier: a letter or underscore,
+	// followed by letters, digits and underscores.
+	bool validName = !name.empty() && !isdigit((unsigned char)name[0]);
 
-	if (treeStream.fail()) // If the tree stream fails to open,
+	for (unsigned int i = 0; i < name.length(); i++)
 	{
-		cout << "Unable to open tree file." << endl; // we print a message saying we couldn't open the tree file,
+		validName = validName && (isalnum((unsigned char)name[i]) || name[i] == '_');
+	}
 
-		closeStreams(); // close out the other streams since they are open by this point,
+	if (!validName) // If it isn't,
+	{
+		reportError("Invalid codebook name!"); // we print that out and return, since we can't do anything.
 
-		return; // and return because we are done at this point.
+		return;
 	}
 
-	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
+	if (!openStreams(treeFile, outputFile)) // If we are unable to open the input and output streams,
 	{
 		return; // we return, since we can't do anything.
 	}
 
-	// We build the tree from the tree builder in the first 510 bytes of the input file.
-	// This method will read the first 510 bytes of the tree stream file, building a huffman tree,
-	// that we will use to encode the file. By passing true as the second parameter if this method,
-	// it will write the tree builder bytes to the output stream so that the file can be decoded properly.
-	buildTreeFromTreeBuilder(treeStream, true);
+	if (!buildTreeFromTreeBuilder(inputStream)) // We build the tree from the tree file. If it doesn't have a valid tree builder,
+	{
+		closeStreams(); // we close our streams,
 
-	treeStream.close(); // Close the tree stream since we've finished building our Huffman tree
+		reportError("Invalid tree file."); // and say so.
 
-	buildEncodingTable(); // We build the encoding table so we can encode each character of the input file.
+		return;
+	}
 
-	encodeBytes(); // Now we encode each byte of the input stream.
+	bytesIn += HuffmanFormat::TREE_BUILDER_SIZE; // We read the tree builder, so we add its size to our bytes in.
+
+	int maxLength = 0; // The length of the longest code, which tells us how many bytes each code needs
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
+	{
+		maxLength = max(maxLength, (int)tables->lengths[i]);
+	}
+
+	int codeBytes = (maxLength + 7) / 8;
+
+	outputStream << "// Generated by HUFF -g from " << treeFile << ". Do not edit.\n";
+	outputStream << "// Encode and decode with FixedHuffmanCoder<" << name << ">.\n\n";
+	outputStream << "#pragma once\n\n";
+	outputStream << "struct " << name << " {\n";
+	outputStream << "\tstatic constexpr int MAX_LENGTH = " << maxLength << ";\n";
+	outputStream << "\tstatic constexpr int CODE_BYTES = " << codeBytes << ";\n";
+	outputStream << "\tstatic constexpr int TABLE_BITS = " << CODEBOOK_TABLE_BITS << ";\n\n";
+
+	// The tree builder bytes, so files encoded with the codebook can be decoded without it, and the other way around.
+	outputStream << "\tstatic constexpr unsigned char treeBuilder[" << HuffmanFormat::TREE_BUILDER_SIZE << "] = {";
+
+	for (int i = 0; i < HuffmanFormat::TREE_BUILDER_SIZE; i++)
+	{
+		outputStream << (i % 16 == 0 ? "\n\t\t" : " ") << (unsigned int)(unsigned char)treeBuilder[i] << ",";
+	}
+
+	outputStream << "\n\t};\n\n";
+
+	// The length of the code of every symbol.
+	outputStream << "\tstatic constexpr unsigned char lengths[" << AMOUNT_OF_CHARACTERS << "] = {";
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
+	{
+		outputStream << (i % 16 == 0 ? "\n\t\t" : " ") << (unsigned int)tables->lengths[i] << ",";
+	}
+
+	outputStream << "\n\t};\n\n";
+
+	// The bits of the code of every symbol, packed into bytes starting with the highest bit.
+	outputStream << "\tstatic constexpr unsigned char codes[" << AMOUNT_OF_CHARACTERS << "][" << codeBytes << "] = {\n";
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
+	{
+		outputStream << "\t\t{";
+
+		for (int j = 0; j < codeBytes; j++)
+		{
+			outputStream << (j == 0 ? " " : ", ") << (unsigned int)tables->codes[i][j];
+		}
+
+		outputStream << " },\n";
+	}
+
+	outputStream << "\t};\n\n";
+
+	// The left and right child of every internal node.
+	outputStream << "\tstatic constexpr unsigned short children[" << AMOUNT_OF_CHARACTERS - 1 << "][2] = {";
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS - 1; i++)
+	{
+		outputStream << (i % 8 == 0 ? "\n\t\t" : " ") << "{ " << tables->children[i][0] << ", " << tables->children[i][1] << " },";
+	}
+
+	outputStream << "\n\t};\n\n";
+
+	// What the next TABLE_BITS bits of the encoded bits decode to. We follow them down the tree from the root,
+	// stopping at the first leaf. If we reach one, the entry is the leaf and the length of its code. If the code
+	// is longer than that, the entry is the node all of the bits lead to, and the decoder goes on from there.
+	outputStream << "\tstatic constexpr unsigned short decodeTable[" << (1 << CODEBOOK_TABLE_BITS) << "][2] = {";
+
+	for (int i = 0; i < 1 << CODEBOOK_TABLE_BITS; i++)
+	{
+		unsigned short node = 0; // We start at the root,
+
+		int bitsUsed = 0;
+
+		while (bitsUsed < CODEBOOK_TABLE_BITS && node < HuffmanTables::LEAF) // and follow the bits, highest first, until we reach a leaf or run out.
+		{
+			node = tables->children[node][(i >> (CODEBOOK_TABLE_BITS - 1 - bitsUsed)) & 1];
+
+			bitsUsed++;
+		}
+
+		outputStream << (i % 8 == 0 ? "\n\t\t" : " ") << "{ " << node << ", " << bitsUsed << " },";
+	}
+
+	outputStream << "\n\t};\n";
+	outputStream << "};\n";
+
+	bytesOut = outputStream.tellp(); // Everything we wrote is the header, so that's our bytes out.
+
+	closeStreams(); // We've finished writing the header so we close our input and output streams.
+
+	printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
+}
+
+unsigned short Huffman::buildDecodingTable(treenode* node, unsigned short& nextIndex)
+{
+	// This recursive method numbers the internal nodes under the given node in the order they
+	// are reached, putting the numbers of their left and right children into their row of
+	// the decoding table. Leaves don't need a row of their own, so they are numbered by their
+	// symbol, plus LEAF to tell them apart from internal nodes. It returns the number of the
+	// given node.
+	//
+	if (isLeaf(node)) // If the node is a leaf,
+	{
+		return HuffmanTables::LEAF + node->symbol; // its number comes from its symbol.
+	}
+
+	unsigned short index = nextIndex++; // Otherwise, it gets the next row of the table,
+
+	builtTables.children[index][0] = buildDecodingTable(node->leftChild, nextIndex); // and we number its children after it.
+	builtTables.children[index][1] = buildDecodingTable(node->rightChild, nextIndex);
+
+	return index;
+}
+
+void Huffman::navigateTree(unsigned char byte, int bitToCheck, unsigned short& node)
+{
+	// This method navigates to a child of the given node by checking if the given bit
+	// is flipped on in the given byte. This is used during the decoding process to
+	// find characters to write to the ouput file. Nodes are rows of the decoding table,
+	// so that the tables can come from a table cache without any nodes being built.
+	// Something important to note is the use of a node reference - the reason we are
+	// using this is so that we can change the node to a different one and have it
+	// properly update for the caller of this method.
+	//
+	// First, we do a bitwise AND of the given byte and bit we are checking. If the result is a non-zero value,
+	// it means that the specific bit of the byte was turned on, or 1, so we navigate to the right child. Otherwise,
+	// we navigate to the left child.
+	node = tables->children[node][byte & bitToCheck ? 1 : 0];
+
+	if (node >= HuffmanTables::LEAF) // If the node is a leaf, it holds a symbol,
+	{
+		outputStream.put((char)(node - HuffmanTables::LEAF)); // so we write it to the output stream,
+
+		bytesOut++; // increment our bytes out counter since we just wrote a byte,
+
+		symbolsLeft--; // count the symbol off of the ones left to decode,
+
+		node = 0; // and reset the node reference back to the root of the tree for future calls.
+	}
+}
+
+bool Huffman::decodeBytes(unsigned long long dataLength, unsigned long long symbolCount)
+{
+	// This method decodes the given amount of bytes of the input stream. We do this
+	// by reading in each byte of the input stream, and navigate the Huffman
+	// tree repeatedly until we reach a leaf node, then write the node's symbol
+	// to the output stream. We then start back at the root of the Huffman tree
+	// and continue until we are out of bytes. The amount of bytes is passed in
+	// so that we stop before a seek table at the end of the file. The amount of
+	// symbols is passed in so that we stop exactly at the end of the original file,
+	// instead of decoding the bits that fill out the last byte. Files written before
+	// the header had the original length pass in ULLONG_MAX, and end with padding
+	// bits that never finish a symbol instead.
+	//
+	// Returns true if every symbol was decoded, and false if the input ran out first.
+	//
+	char character; // This variable will hold each character we read from the input stream.
+
+	// We set a variable for the current node at the first row of the decoding table,
+	// since by this point, we will have our tables and the root will always be row 0.
+	// We use it to navigate the Huffman tree, finding leaf nodes so that we can write
+	// their symbols to the file.
+	unsigned short currentNode = 0;
+
+	symbolsLeft = symbolCount; // We haven't decoded any symbols yet, so every symbol is left.
+
+	// While we have symbols left to decode, haven't reached the end of the encoded bits, and the input stream
+	// successfully reads in a character,
+	while (symbolsLeft > 0 && dataLength > 0 && inputStream.get(character))
+	{
+		dataLength--; // We have one less byte of encoded bits left to read.
+
+		bytesIn++; // We increment our bytes in counter since we have read a byte.
+
+		// We are using our character as a an 8-bit byte with a value of 0 to 255, so we implicitly
+		// cast it into a unsigned char.
+		unsigned char byte = character;
+
+		// Every code is at least one bit long, so a byte can finish at most 8 symbols. If there are fewer
+		// than 8 symbols left, the byte may end with bits that come after the last symbol, so we go
+		// through it one bit at a time and stop as soon as the last symbol is decoded.
+		if (symbolsLeft < 8)
+		{
+			for (int bitToCheck = 128; bitToCheck != 0 && symbolsLeft > 0; bitToCheck >>= 1)
+			{
+				navigateTree(byte, bitToCheck, currentNode);
+			}
+
+			continue;
+		}
+
+		// An interesting thing to note is that I had tested writing this in a different way. I made a
+		// member variables that was an int array with the powers of 2, from 1 to 128, and I would loop
+		// through each power and I inlined the navigateTree method in the for loop. Somehow, that performed
+		// worse (although only very slightly) than having a navigateTree method and calling it 8 times,
+		// so I stuck with this method, even though there are quite a bit of repeated lines.
+		navigateTree(byte, 128, currentNode); // Use the navigateTree method to go to the correct node's child based on the first bit from the left
+		navigateTree(byte, 64, currentNode); // Use the navigateTree method to go to the correct node's child based on the second bit
+		navigateTree(byte, 32, currentNode); // Use the navigateTree method to go to the correct node's child based on the third bit
+		navigateTree(byte, 16, currentNode); // Use the navigateTree method to go to the correct node's child based on the fourth bit
+		navigateTree(byte, 8, currentNode); // Use the navigateTree method to go to the correct node's child based on the fifth bit
+		navigateTree(byte, 4, currentNode); // Use the navigateTree method to go to the correct node's child based on the sixth bit
+		navigateTree(byte, 2, currentNode); // Use the navigateTree method to go to the correct node's child based on the seventh bit
+		navigateTree(byte, 1, currentNode); // Use the navigateTree method to go to the correct node's child based on the eighth bit
+	}
+
+	// If we knew how many symbols there were, we should have decoded every one of them.
+	return symbolCount == ULLONG_MAX || symbolsLeft == 0;
+}
+
+void Huffman::encodeBits(unsigned char& outputCharacter, int& currentBit, string& bits)
+{
+	// This method encodes the given string of bits into the output character.
+	// The given currentBit keeps track of which bit we are changing in the
+	// output character. Once we hit 8, we write to the output file, reset
+	// our outputCharacter and currentBit, and continue.
+	//
+	for (unsigned int i = 0; i < bits.length(); i++) // Loop through every character of the bits string
+	{
+		// If the character at index i is equal to '1', it means that we need to encode a 1 at the current bit.
+		// Otherwise, we will be encoding a 0 for off.
+		bool on = bits[i] == '1';
+
+		// Here, we are building the output character or byte bit by bit. To turn on a specific bit of of a byte,
+		// we just need to use a bitwise OR operator with it and another byte that just has one bit turned on,
+		// like 0000 1000, for example. Since we are using currentBit to represent the bit we are on, beginning from
+		// the left, we can use it to determine which bit we will be changing. First, we use the bitwise OR equal
+		// operator. We then take our boolean on, which is either true or false, which in, and use the shift
+		// left operator to shift its value of 1 or 0 to the left a certain number of times to represent the
+		// bit we are changing. Our boolean ends up getting implicitly casted as an integer when using this shift
+		// operator. If on is true and currentBit is 0 for example, we would start with the byte 0000 0001, and
+		// then shift it to the left 7 - 0 times, resulting in 1000 0000. Now we bitwise OR it with our output
+		// character and put the result in our output character variable, successfully flipping a bit in our
+		// output character.
+		outputCharacter |= (on << (7 - currentBit));
+
+		currentBit++; // We now increment the currentBit so that we can take care of the next bit inside of our output character.
+
+		if (currentBit == 8) // If the current bit is 8, we have taken care of all bits inside of the output character.
+		{
+			outputStream.put(outputCharacter); // Since we've finished this character, we write it to the output stream,
+
+			bytesOut++; // increment our bytes out by 1 since we've written a byte,
+
+			outputCharacter = 0; // reset our output character back to 0,
+
+			currentBit = 0; // and reset the current bit back to 0.
+		}
+	}
+}
+
+void Huffman::encodeBytes(unsigned long long length)
+{
+	// This method encodes each character of the input stream by finding its encoding bits
+	// in the encoding table and writes them out to the output stream as bytes are formed from
+	// each set of 8 bits. We stop after the given amount of characters, so a block of the
+	// input can be encoded on its own, or at the end of the input.
+	//
+	char character; // This variable will hold each character we read from the input stream
+
+	unsigned char outputCharacter = 0; // This character will hold the byte we will be writing out to the output stream.
+
+	int currentBit = 0; // The current bit we are changing in the output character
+
+	// The bytes out counter before any encoded bits are written, so that we can work out the bit offset of each seek table entry.
+	unsigned long long dataStart = bytesOut;
+
+	unsigned long long symbolPosition = 0; // The amount of symbols we have encoded so far
+
+	unsigned int symbolsUntilSeekEntry = 0; // The amount of symbols left to encode before we record the next seek table entry
+
+	// While we haven't encoded every character we were asked to and the input stream successfully reads in a character,
+	// we will encode the character's bits.
+	while (length > 0 && inputStream.get(character))
+	{
+		length--;
+
+		if (seekInterval != 0 && blocks.empty()) // If we are writing a seek table, which files split into blocks don't have,
+		{
+			if (symbolsUntilSeekEntry == 0) // and this symbol starts a new interval,
+			{
+				// we record where it is - the amount of symbols before it, and the amount of encoded bits before it,
+				// which is every full byte we have written since we started plus the bits of the current output character.
+				seekTable.push_back(make_pair(symbolPosition, (bytesOut - dataStart) * 8 + currentBit));
+
+				symbolsUntilSeekEntry = seekInterval; // The next entry will be an interval from now.
+			}
+
+			symbolsUntilSeekEntry--; // Either way, we are one symbol closer to the next entry.
+		}
+
+		// By coercing the character into an unsigned char, we solve the issue with invalid array indexing - normally,
+		// a char will range from -128 to 127, so without this, we may access the array at index -127 to -1!
+		// By casting it to a unsigned char, it's value will range from 0 to 255, fixing any possible indexing issues.
+		//
+		unsigned char symbol = character;
+
+		string& bitString = encodingTable[symbol]; // We get the bit string for encoding the symbol we read from the file.
+
+		encodeBits(outputCharacter, currentBit, bitString); // We encode the bits of the symbol into our output character.
+
+		bytesIn++; // We increment the bytes in by one, since we have read another byte of the file.
+
+		symbolPosition++; // We have also encoded one more symbol.
+	}
+
+	// At this point, we may be in the middle of an output character, and we don't want to forget to write
+	// its bits to our file. The rest of its bits are already 0, and since the header has the length of
+	// the original file, the decoder knows to stop before them, so we just write it as is.
+	if (currentBit != 0)
+	{
+		outputStream.put(outputCharacter); // Since we've finished this character, we write it to the output stream,
+
+		bytesOut++; // increment our bytes out by 1 since we've written a byte,
+	}
+}
+
+void Huffman::EncodeFile(string inputFile, string outputFile)
+{
+	// This method encodes the given input file into the given output file.
+	// To do this, we open the streams, encode the input stream into the output
+	// stream, and then finish up by closing the streams and printing our final info.
+	//
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
+	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
+	{
+		return; // we return, since we can't do anything.
+	}
+
+	encode(); // We encode the input file into the output file.
 
 	closeStreams(); // We've finished encoding each byte of the file, so we close our input and output streams.
 
+	if (!samplingReport.empty()) // If we tried to build the tree from a sample,
+	{
+		cout << samplingReport << endl; // we say how it went.
+	}
+
+	if (!verificationError.empty()) // If we were verifying the output and it didn't decode to the input,
+	{
+		reportError("Verification failed: " + verificationError); // we say what went wrong.
+
+		return;
+	}
+
+	if (verifyEnabled) // If it did,
+	{
+		cout << "Verified: the output decodes to the input." << endl; // we say so.
+	}
+
 	printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
 }
 
+void Huffman::DecodeFile(string inputFile, string outputFile)
+{
+	// This method decodes the given input file into the given output file.
+	// To do this, we open the streams, decode the input stream into the output
+	// stream, and then finish up by closing the streams and printing our final info.
+	// The output file may have been made as big as the whole original file before
+	// decoding started, so if decoding fails partway through, we cut it back down
+	// to what we actually wrote, instead of leaving zeros where the rest would be.
+	//
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
+	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
+	{
+		return; // we return, since we can't do anything.
+	}
+
+	bool decoded = decode(); // We decode the input file into the output file, remembering if we were able to.
+
+	closeStreams(); // We've finished decoding each byte of the file, so we close our input and output streams.
+
+	if (decoded) // If we were able to decode the file,
+	{
+		printFinalInfo(); // we're done, so we can print the elapsed time and amount of bytes in and out.
+	}
+	else // Otherwise, the output only has the bytes we decoded before we stopped.
+	{
+		truncateOutput(outputFile, bytesOut);
+	}
+}
+
+void Huffman::EncodeFileWithTree(string inputFile, string TreeFile, string outputFile)
+{
+	// This method encodes the given input file into the given output file, but
+	// uses the given tree file to build the Huffman tree. To do this, we open the streams,
+	// encode the input stream into the output stream using the tree file, and then finish
+	// up by closing the streams and printing our final info.
+	//
+	// If we don't open the tree stream first and make sure its valid, we will accidentally create
+	// an empty output file on failure of opening the tree stream file.
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
+	ifstream treeStream; // We declare another ifstream so we can read our tree file.
+
+	// Open the tree stream with the tree file as the path. We need to open the stream in binary mode,
+	// since we are going to read the file in binary instead of text.
+	treeStream.open(TreeFile, ios::binary);
+
+	if (treeStream.fail()) // If the tree stream fails to open,
+	{
+		reportError("Unable to open tree file."); // we print a message saying we couldn't open the tree file,
+
+		return; // and return because we are done at this point.
+	}
+
+	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
+	{
+		return; // we return, since we can't do anything.
+	}
+
+	bool encoded = encodeWithTree(treeStream); // We encode the input file into the output file using the tree file.
+
+	treeStream.close(); // Close the tree stream since we've finished building our Huffman tree
+
+	closeStreams(); // We've finished encoding each byte of the file, so we close our input and output streams.
+
+	if (!encoded) // If the tree file didn't have a valid tree builder,
+	{
+		reportError("Invalid tree file."); // we couldn't encode the file.
+
+		return;
+	}
+
+	if (!verificationError.empty()) // If we were verifying the output and it didn't decode to the input,
+	{
+		reportError("Verification failed: " + verificationError); // we say what went wrong.
+
+		return;
+	}
+
+	if (verifyEnabled) // If it did,
+	{
+		cout << "Verified: the output decodes to the input." << endl; // we say so.
+	}
+
+	printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
+}
+
+bool Huffman::EncodeBuffer(const char* data, size_t size, string& output)
+{
+	// This method encodes the given bytes into the given string. It works just like
+	// EncodeFile, except our streams read straight from the given memory and write
+	// straight into the string, and nothing is printed since there is no user watching.
+	//
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
+	MemoryInputBuffer inputBuffer(data, size); // A stream buffer that reads the given bytes without copying them
+	StringOutputBuffer outputBuffer(output); // A stream buffer that writes into the given string
+
+	attachStreams(&inputBuffer, &outputBuffer); // We point our streams at the buffers,
+
+	outputString = &outputBuffer;
+
+	encode(); // encode the bytes,
+
+	closeStreams(); // and let go of the buffers, since they are about to go away.
+
+	outputBuffer.finish(); // We trim the string down to the bytes we wrote.
+
+	// Every byte has a code, so encoding can only fail if we were verifying the output and it didn't decode to the input.
+	if (!verificationError.empty())
+	{
+		lastError = "Verification failed: " + verificationError;
+
+		return false;
+	}
+
+	return true;
+}
+
+bool Huffman::DecodeBuffer(const char* data, size_t size, string& output)
+{
+	// This method decodes the given encoded bytes into the given string, just like
+	// DecodeFile does for files. It returns false if the bytes can't be decoded.
+	//
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
+	MemoryInputBuffer inputBuffer(data, size); // A stream buffer that reads the given bytes without copying them
+	StringOutputBuffer outputBuffer(output); // A stream buffer that writes into the given string
+
+	attachStreams(&inputBuffer, &outputBuffer); // We point our streams at the buffers,
+
+	outputString = &outputBuffer;
+
+	bool decoded = decode(); // decode the bytes, remembering if we were able to,
+
+	closeStreams(); // and let go of the buffers, since they are about to go away.
+
+	outputBuffer.finish(); // We trim the string down to the bytes we wrote.
+
+	return decoded;
+}
+
+bool Huffman::EncodeBufferWithTree(const char* data, size_t size, const string& treeBuilder, string& output)
+{
+	// This method encodes the given bytes into the given string using the given tree
+	// builder bytes, just like EncodeFileWithTree does for files. If this instance
+	// already has the tree built, it is used as is. It returns false if the tree
+	// builder bytes are the wrong size or don't describe a tree, or if we were
+	// verifying the output and it didn't decode to the input.
+	//
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
+	if (treeBuilder.size() != HuffmanFormat::TREE_BUILDER_SIZE) // If we weren't given a whole tree builder,
+	{
+		lastError = "Invalid tree file."; // we can't build a tree from it.
+
+		return false;
+	}
+
+	MemoryInputBuffer treeBuffer(treeBuilder.data(), treeBuilder.size()); // A stream buffer that reads the tree builder bytes,
+
+	istream treeStream(&treeBuffer); // and a stream over it, so it can be read like a tree file.
+
+	MemoryInputBuffer inputBuffer(data, size); // A stream buffer that reads the given bytes without copying them
+	StringOutputBuffer outputBuffer(output); // A stream buffer that writes into the given string
+
+	attachStreams(&inputBuffer, &outputBuffer); // We point our streams at the buffers,
+
+	outputString = &outputBuffer;
+
+	bool encoded = encodeWithTree(treeStream); // encode the bytes with the tree, remembering if we were able to,
+
+	closeStreams(); // and let go of the buffers, since they are about to go away.
+
+	outputBuffer.finish(); // We trim the string down to the bytes we wrote.
+
+	if (!encoded) // If the tree builder didn't describe a tree, or the output didn't decode to the input, we say why.
+	{
+		lastError = "Invalid tree file.";
+	}
+	else if (!verificationError.empty())
+	{
+		lastError = "Verification failed: " + verificationError;
+	}
+
+	return lastError.empty();
+}
+
+const HuffmanTables* Huffman::GetTables(const string& treeBuilder)
+{
+	// This method builds the tree for the given tree builder bytes, unless it is already built
+	// or in the table cache, and returns its tables, for decoders that don't use our streams.
+	// The tables stay valid until a different tree is built. If the bytes don't describe a
+	// tree, we return nullptr.
+	//
+	MemoryInputBuffer treeBuffer(treeBuilder.data(), treeBuilder.size()); // We read the tree builder bytes straight out of the string.
+
+	istream treeStream(&treeBuffer);
+
+	return buildTreeFromTreeBuilder(treeStream) ? tables : nullptr;
+}
+
+const string& Huffman::GetTreeBuilder()
+{
+	// This method returns the tree builder bytes of the tree that is currently built. Callers
+	// that keep several instances around can use it to find one that already has the tree
+	// they need, so it doesn't have to be built again.
+	//
+	return treeBuilder;
+}
+
+const string& Huffman::GetError()
+{
+	// This method returns why the last operation failed. Operations on files print this
+	// as well, but the ones on buffers don't print anything, so this is the only way
+	// their callers can find out what went wrong.
+	//
+	return lastError;
+}
+
+void Huffman::encode()
+{
+	// This method encodes the input stream into the output stream. To do this, we build a
+	// Huffman tree from the input stream, and check if coding the input would actually make
+	// it smaller. If it wouldn't, like for files that are already compressed, we write the
+	// header and then just copy the input as is. Otherwise, we write the header and the tree
+	// builder, build our encoding table for each character, and encode the bytes, followed by
+	// the seek table if we want one.
+	//
+	// We build the tree. This method will read the bytes of the input file, building a frequency table
+	// and huffman tree, and counting the bytes of the input. Since we don't want to increment the bytes
+	// here, we pass in false.
+	//
+	// If we were asked to sample the input, we try building the tree from a sample of it first, and
+	// only count every byte if the input is too small for that or the sample doesn't represent it.
+	//
+	// If we were asked to split the input into blocks, we count every block instead, which needs every
+	// byte anyway, and build the shared tree from the whole input.
+	if (blockSize != 0)
+	{
+		countBlocks();
+
+		buildTreeFromFrequencies();
+	}
+	else if (sampleSize == 0 || !buildTreeFromSample())
+	{
+		buildTree(false);
+	}
+
+	// Building the tree read the input stream, so we go back to the beginning of it to read it again.
+	inputStream.clear();
+	inputStream.seekg(0);
+
+	// Then we store the input as is if coding it wouldn't pay off, and code it otherwise. With blocks,
+	// planning how to store each block tells us that, and otherwise the frequencies do.
+	encodeInput(blockSize != 0 ? !planBlocks() : shouldStore());
+}
+
+void Huffman::encodeInput(bool stored)
+{
+	// This method writes the input stream to the output stream once the tree is built: the header,
+	// then either the input as is, or the tree builder, the encoded bits and the seek table.
+	//
+	// If we were asked for a checksum, the input stream reads through a buffer that checksums every
+	// byte on its way to the encoder, so it costs no extra pass over the input. The checksum isn't
+	// known until the last byte has been read, so we write the header with a placeholder and fill
+	// it in at the end. If we were asked to verify, the output stream writes through a buffer that
+	// also hands the output to a stream decoder on a thread of its own, and we compare what it
+	// decodes with the input once we're done, without writing or reading anything else. Without
+	// either, nothing needs the checksum, so we read the input directly.
+	//
+	unique_ptr<ChecksumInputBuffer> checksumBuffer; // The buffer that checksums the input, if anything needs the checksum
+
+	streambuf* input = inputStream.rdbuf();
+
+	if (checksumEnabled || verifyEnabled) // If we were asked for a checksum or to verify,
+	{
+		checksumBuffer.reset(new ChecksumInputBuffer(input));
+
+		inputStream.rdbuf(checksumBuffer.get()); // we read through the buffer that checksums the input.
+	}
+
+	unique_ptr<HuffmanVerifier> verifier; // The buffer that decodes the output, if we are verifying
+
+	streambuf* output = outputStream.rdbuf();
+
+	if (verifyEnabled) // If we are verifying,
+	{
+		verifier.reset(new HuffmanVerifier(output));
+
+		outputStream.rdbuf(verifier.get()); // we write through the verifier.
+	}
+
+	writeHeader(stored); // We write a header saying how the input is stored, so decoders know which sections the file has.
+
+	if (stored) // If the input is being stored as is,
+	{
+		copyBytes(); // we copy every byte of the input stream straight to the output stream.
+	}
+	else if (!blocks.empty()) // If the input is split into blocks,
+	{
+		writeBlocks(); // we write each block the way we planned to.
+	}
+	else // Otherwise,
+	{
+		writeTreeBuilder(); // we write the tree builder bytes, so the tree can be rebuilt when decoding.
+
+		buildEncodingTable(); // We build the encoding table so we can encode each character of the input file.
+
+		encodeBytes(); // Now we encode each byte of the input stream.
+
+		writeSeekTable(); // If we were asked for a seek table, we write it after the encoded bits.
+	}
+
+	outputStream.flush(); // We make sure everything has gone through the verifier,
+
+	inputStream.rdbuf(input); // and go back to reading
+	outputStream.rdbuf(output); // and writing directly.
+
+	if (verifier) // If we were verifying, we wait for the decoder to catch up and check what it decoded.
+	{
+		verificationError = verifier->Finish(checksumBuffer->GetChecksum(), inputLength);
+	}
+
+	if (checksumEnabled) // If we were asked for a checksum, we now know what it is,
+	{
+		outputStream.seekp(HuffmanFormat::CHECKSUM_POSITION); // so we go back to its spot in the header,
+
+		HuffmanFormat::writeNumber(outputStream, checksumBuffer->GetChecksum(), HuffmanFormat::CHECKSUM_SIZE); // write it,
+
+		outputStream.seekp(0, ios::end); // and go back to the end of the file.
+	}
+}
+
+bool Huffman::decode()
+{
+	// This method decodes the input stream into the output stream. To do this, we read the
+	// header if the input has one, and build a Huffman tree from the tree builder in the
+	// input, which is the 510 bytes after the header. We then decode the encoded bytes.
+	// If the header has the length of the original file, we make room for the whole output
+	// before we start and stop decoding exactly at the end of it. If the input has a header
+	// we can't understand, or is cut off or corrupt, we say so and return false.
+	//
+	HuffmanFormat::header fileHeader; // The header of the input file, which tells us which optional sections it has.
+
+	if (!readHeader(fileHeader)) // If the file has a header we can't understand,
+	{
+		return false; // we return false, since we can't decode it.
+	}
+
+	if (!(fileHeader.flags & HuffmanFormat::FLAG_CHECKSUM)) // If the file doesn't have a checksum,
+	{
+		return decodeContents(fileHeader); // we just decode it.
+	}
+
+	// Otherwise, we write through a buffer that checksums every byte we decode on its way out,
+	// so we can compare it with the checksum in the header without reading the output again.
+	ChecksumOutputBuffer checksumBuffer(outputStream.rdbuf());
+
+	streambuf* output = outputStream.rdbuf(&checksumBuffer);
+
+	bool decoded = decodeContents(fileHeader);
+
+	outputStream.flush(); // We make sure every byte has gone through the checksum,
+
+	outputStream.rdbuf(output); // and go back to writing directly.
+
+	if (decoded && checksumBuffer.GetChecksum() != fileHeader.checksum) // If the output doesn't match the checksum,
+	{
+		reportError("The input file is corrupt."); // something changed the input after it was encoded.
+
+		return false;
+	}
+
+	return decoded;
+}
+
+bool Huffman::decodeContents(const HuffmanFormat::header& fileHeader)
+{
+	// This method decodes whatever follows the given header, which has already been read from
+	// the input stream. Stored files are copied as is, and coded files are decoded with the tree
+	// built from the tree builder that comes next. If the input is cut off or has an invalid
+	// tree builder, we say so and return false.
+	//
+	bool lengthKnown = fileHeader.originalLength != HuffmanFormat::UNKNOWN_LENGTH; // Older files don't have the original length.
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_BLOCKS) // If the input is split into blocks,
+	{
+		return decodeBlocks(fileHeader); // each one says how to decode it.
+	}
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_STORED) // If the input was stored rather than coded,
+	{
+		if (lengthKnown) // and we know how long it is,
+		{
+			preallocateOutput(fileHeader.originalLength); // we make room for all of it up front.
+		}
+
+		// Everything after the header is the original bytes, so we copy them straight through. If we
+		// don't know the length, the unknown length is the largest number there is, so we copy everything.
+		copyBytes(fileHeader.originalLength);
+
+		if (lengthKnown && bytesOut != fileHeader.originalLength) // If we ran out before the end of the original bytes,
+		{
+			reportError("The input file is truncated."); // the input was cut off.
+
+			return false;
+		}
+
+		return true;
+	}
+
+	// We build the tree from the tree builder in the 510 bytes after the header.
+	// This method will read those 510 bytes of the input file, building a huffman tree,
+	// that we will use to decode the file.
+	if (!buildTreeFromTreeBuilder(inputStream)) // If there aren't 510 bytes or they don't describe a tree,
+	{
+		reportError("The input file has an invalid tree builder."); // we can't decode the file.
+
+		return false;
+	}
+
+	// We need to add 510 bytes to the bytes we've read in, since we read the first 510 bytes.
+	// The buildTreeFromTreeBuilder method does not do this, so I'm just doing it here instead.
+	bytesIn += 510;
+
+	unsigned long long dataLength; // The amount of bytes of encoded bits
+
+	if (!getDataLength(fileHeader, dataLength)) // If the seek table doesn't fit in the file, we can't tell where the encoded bits end.
+	{
+		reportError("The input file has an invalid seek table.");
+
+		return false;
+	}
+
+	if (lengthKnown) // If we know how long the original file is,
+	{
+		// every symbol takes at least one bit, so there can't be more symbols than bits. If the
+		// header says there are, it's corrupt, and we don't want to make room for that much.
+		if (fileHeader.originalLength / 8 > dataLength)
+		{
+			reportError("The input file is truncated.");
+
+			return false;
+		}
+
+		preallocateOutput(fileHeader.originalLength); // Otherwise, we make room for the whole output up front.
+	}
+
+	// Now, we decode each byte of encoded bits in the input stream, stopping after the last symbol
+	// if we know how many there are.
+	if (!decodeBytes(dataLength, fileHeader.originalLength)) // If we ran out of encoded bits first,
+	{
+		reportError("The input file is truncated."); // the input was cut off.
+
+		return false;
+	}
+
+	return true;
+}
+
+bool Huffman::decodeBlocks(const HuffmanFormat::header& fileHeader)
+{
+	// This method decodes a file that is split into blocks. After the block size and shared tree
+	// builder, each block says how it is stored, so we copy it as is, or switch to its tree and
+	// decode it. Every block but the last has the block size worth of symbols, so we always know
+	// exactly how many to decode. If the input is cut off or a block is invalid, we say so and
+	// return false.
+	//
+	unsigned int size;			// The amount of symbols in each block,
+	string sharedTree;			// the tree builder bytes of the shared tree,
+	string previousTree;		// and of the last block that brought its own tree.
+
+	// Files split into blocks always have the original length, since that's how we know how long the last block is.
+	if (fileHeader.originalLength == HuffmanFormat::UNKNOWN_LENGTH || !readBlockStart(size, sharedTree))
+	{
+		reportError("The input file has an invalid block.");
+
+		return false;
+	}
+
+	unsigned long long dataLength; // The amount of bytes of blocks
+
+	if (!getDataLength(fileHeader, dataLength)) // If the seek table doesn't fit in the file, we can't tell where the blocks end.
+	{
+		reportError("The input file has an invalid seek table.");
+
+		return false;
+	}
+
+	// Every symbol takes at least one bit, so there can't be more symbols than bits. If the header
+	// says there are, it's corrupt, and we don't want to make room for that much.
+	if (fileHeader.originalLength / 8 > dataLength)
+	{
+		reportError("The input file is truncated.");
+
+		return false;
+	}
+
+	preallocateOutput(fileHeader.originalLength); // Otherwise, we make room for the whole output up front.
+
+	unsigned long long left = fileHeader.originalLength; // The amount of symbols in the blocks we haven't decoded
+
+	while (left > 0)
+	{
+		unsigned char mode;				// How the block is stored,
+		unsigned long long dataLength;	// and how many bytes of data it has.
+
+		if (!readBlockHeader(mode, dataLength, previousTree))
+		{
+			reportError("The input file has an invalid block.");
+
+			return false;
+		}
+
+		unsigned long long count = left < size ? left : size; // The amount of symbols in the block
+
+		if (mode == HuffmanFormat::BLOCK_STORED) // If the block is stored as is,
+		{
+			if (dataLength != count) // it has to have a byte for each symbol.
+			{
+				reportError("The input file has an invalid block.");
+
+				return false;
+			}
+
+			unsigned long long before = bytesOut;
+
+			copyBytes(count); // We copy them straight through.
+
+			if (bytesOut - before != count) // If we ran out before the end of the block,
+			{
+				reportError("The input file is truncated."); // the input was cut off.
+
+				return false;
+			}
+		}
+		else // Otherwise, we switch to the block's tree and decode its symbols.
+		{
+			if (GetTables(mode == HuffmanFormat::BLOCK_SHARED_TREE ? sharedTree : previousTree) == nullptr)
+			{
+				reportError("The input file has an invalid tree builder.");
+
+				return false;
+			}
+
+			streampos dataStart = inputStream.tellg(); // Where the data of the block starts
+
+			if (!decodeBytes(dataLength, count)) // If we ran out of encoded bits first,
+			{
+				reportError("The input file is truncated."); // the input was cut off.
+
+				return false;
+			}
+
+			// The last symbol may end before the last byte of the block's data, so we make sure the next block starts where it should.
+			inputStream.seekg(dataStart + (streamoff)dataLength);
+		}
+
+		left -= count;
+	}
+
+	return true;
+}
+
+bool Huffman::readBlockStart(unsigned int& size, string& sharedTree)
+{
+	// This method reads what comes before the first block of a file that is split into blocks:
+	// the block size and the tree builder bytes of the shared tree. We only check that the
+	// tree builder is all there, since it is built the first time a block uses it.
+	//
+	size = (unsigned int)HuffmanFormat::readNumber(inputStream, HuffmanFormat::BLOCK_SIZE_LENGTH);
+
+	sharedTree.assign(HuffmanFormat::TREE_BUILDER_SIZE, '\0');
+
+	inputStream.read(&sharedTree[0], HuffmanFormat::TREE_BUILDER_SIZE);
+
+	if (!inputStream || size == 0 || size > HuffmanFormat::MAX_BLOCK_SIZE) // If the input ran out or the size is one we never write,
+	{
+		return false; // the file is invalid.
+	}
+
+	bytesIn += HuffmanFormat::BLOCK_SIZE_LENGTH + HuffmanFormat::TREE_BUILDER_SIZE;
+
+	return true;
+}
+
+bool Huffman::readBlockHeader(unsigned char& mode, unsigned long long& dataLength, string& previousTree)
+{
+	// This method reads the header of the next block: how it is stored and how many bytes of data
+	// it has. If the block brings its own tree, we read its tree builder bytes as well, which
+	// become the previous tree from now on. A block can't use the previous tree if there isn't one.
+	//
+	int character = inputStream.get();
+
+	dataLength = HuffmanFormat::readNumber(inputStream, HuffmanFormat::BLOCK_HEADER_SIZE - 1);
+
+	if (!inputStream || character > HuffmanFormat::BLOCK_PREVIOUS_TREE) // If the input ran out or the block is stored some way we don't know,
+	{
+		return false; // the block is invalid.
+	}
+
+	mode = (unsigned char)character;
+
+	bytesIn += HuffmanFormat::BLOCK_HEADER_SIZE;
+
+	if (mode == HuffmanFormat::BLOCK_NEW_TREE) // If the block brings its own tree,
+	{
+		previousTree.assign(HuffmanFormat::TREE_BUILDER_SIZE, '\0'); // its tree builder comes next.
+
+		inputStream.read(&previousTree[0], HuffmanFormat::TREE_BUILDER_SIZE);
+
+		if (!inputStream)
+		{
+			return false;
+		}
+
+		bytesIn += HuffmanFormat::TREE_BUILDER_SIZE;
+	}
+	else if (mode == HuffmanFormat::BLOCK_PREVIOUS_TREE && previousTree.empty()) // If it uses the previous tree, there has to be one.
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool Huffman::encodeWithTree(istream& treeStream)
+{
+	// This method encodes the input stream into the output stream, but uses the given tree
+	// builder stream to build the Huffman tree. To do this, we build a Huffman tree from the
+	// tree builder, write the header and tree builder, build our encoding table for each
+	// character, and encode the bytes, followed by the seek table if we want one. If the
+	// tree builder is invalid, we don't write anything and return false.
+	//
+	// A tree built for other data can code the input much worse than storing it would, since the
+	// characters the input uses most may have the longest codes. So just like when we build our
+	// own tree, we count the input first and store it as is if the codes wouldn't make it smaller.
+	//
+	// We build the tree from the tree builder in the first 510 bytes of the tree stream,
+	// building a huffman tree that we will use to encode the file.
+	if (!buildTreeFromTreeBuilder(treeStream))
+	{
+		return false;
+	}
+
+	if (blockSize != 0) // If we were asked to split the input into blocks, the tree we were given is the shared one,
+	{
+		countBlocks(); // and we count every block so we can choose the tree for each one.
+
+		encodeInput(!planBlocks());
+
+		return true;
+	}
+
+	countFrequencies(false); // We count every character of the input, which also gets us its length.
+
+	// Counting read the input stream, so we go back to the beginning of it to read it again.
+	inputStream.clear();
+	inputStream.seekg(0);
+
+	// We write the header, and then either the input as is if the tree's codes for it would be bigger,
+	// or the tree builder and the encoded bytes, followed by the seek table if we want one.
+	encodeInput(shouldStore());
+
+	return true;
+}
+
+void Huffman::DecodeRange(string inputFile, string outputFile, unsigned long long offset, unsigned long long length)
+{
+	// This method decodes only the bytes from offset to offset + length of the original file
+	// into the given output file. If the input file has a seek table, we look up the last
+	// entry at or before the offset and start decoding there, so we only read the part of
+	// the encoded bits the range needs. Without a seek table, we have to start decoding at
+	// the beginning, throwing away every symbol before the offset.
+	//
+	beginOperation(); // We reset our counters and starting time, since a new operation is beginning.
+
+	if (!openStreams(inputFile, outputFile)) // If we are unable to open the input and output streams,
+	{
+		return; // we return, since we can't do anything.
+	}
+
+	HuffmanFormat::header fileHeader; // The header of the input file, which tells us if it has a seek table.
+
+	if (!readHeader(fileHeader)) // If the file has a header we can't understand,
+	{
+		closeStreams(); // we close our streams,
+
+		return; // and return, since we can't decode it.
+	}
+
+	// The end of the range is one past the last byte we want. If the length is so large that adding it
+	// to the offset would overflow, we just decode until the end of the file.
+	unsigned long long end = length > ULLONG_MAX - offset ? ULLONG_MAX : offset + length;
+
+	if (fileHeader.originalLength != HuffmanFormat::UNKNOWN_LENGTH && end > fileHeader.originalLength) // If we know the range goes past the end,
+	{
+		if (end != ULLONG_MAX) // and it was given on purpose,
+		{
+			cout << "The range goes past the end of the file, so only part of it was decoded." << endl; // we let the user know.
+		}
+
+		end = fileHeader.originalLength; // We stop at the end of the original file, since the bits after it aren't symbols.
+	}
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_STORED) // If the input was stored rather than coded,
+	{
+		// every byte of the original file is right where it was, just after the header, so we jump
+		// straight to the offset and copy the range.
+		inputStream.seekg(offset, ios::cur);
+
+		copyBytes(end > offset ? end - offset : 0);
+
+		closeStreams(); // We've finished copying the range, so we close our input and output streams.
+
+		printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
+
+		return;
+	}
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_BLOCKS) // If the input is split into blocks,
+	{
+		decodeBlockRange(fileHeader, offset, end); // we skip over the blocks before the range and decode the ones in it.
+
+		closeStreams(); // We've finished decoding the range, so we close our input and output streams.
+
+		printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
+
+		return;
+	}
+
+	if (!buildTreeFromTreeBuilder(inputStream)) // We build the tree from the tree builder after the header.
+	{
+		reportError("The input file has an invalid tree builder."); // If we can't, we can't decode the file,
+
+		closeStreams(); // so we close our streams,
+
+		return; // and return.
+	}
+
+	bytesIn += 510; // and add the 510 bytes it took up to our bytes in.
+
+	unsigned long long dataStart = inputStream.tellg(); // The encoded bits start right after the tree builder.
+
+	unsigned long long dataLength; // We also need to know how many bytes of encoded bits there are.
+
+	if (!getDataLength(fileHeader, dataLength)) // If the seek table doesn't fit in the file, we can't tell where they end,
+	{
+		reportError("The input file has an invalid seek table.");
+
+		closeStreams(); // so we close our streams,
+
+		return; // and return.
+	}
+
+	unsigned long long position = 0; // The position in the original file of the symbol we start decoding at,
+
+	unsigned long long bitOffset = 0; // and the amount of encoded bits before it. Without a seek table, both are 0.
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_SEEK_TABLE) // If the file has a seek table,
+	{
+		// we read the amount of entries from the footer at the very end of the file, which tells us
+		// where the table starts. We already know it fits after the encoded bits.
+		unsigned long long tableStart;
+		unsigned long long entryCount;
+
+		readSeekFooter(dataStart, tableStart, entryCount);
+
+		// Now we binary search the table for the last entry at or before the offset. We read each entry
+		// we check straight from the file, so even a huge table only costs us a few small reads. Every
+		// entry before low is at or before the offset, and every entry from high onward is after it.
+		unsigned long long low = 0;
+		unsigned long long high = entryCount;
+
+		while (low < high)
+		{
+			unsigned long long middle = low + (high - low) / 2; // Check the entry halfway between low and high.
+
+			inputStream.seekg(tableStart + middle * HuffmanFormat::SEEK_ENTRY_SIZE);
+
+			if (HuffmanFormat::readNumber(inputStream, 8) <= offset) // If it starts at or before the offset,
+			{
+				low = middle + 1; // the entry we want is this one or one after it.
+			}
+			else
+			{
+				high = middle; // Otherwise, the entry we want is before this one.
+			}
+		}
+
+		if (low > 0) // If there was an entry at or before the offset, low is just past it,
+		{
+			inputStream.seekg(tableStart + (low - 1) * HuffmanFormat::SEEK_ENTRY_SIZE); // so we go back to it
+
+			position = HuffmanFormat::readNumber(inputStream, 8); // and read its symbol position
+			bitOffset = HuffmanFormat::readNumber(inputStream, 8); // and bit offset.
+		}
+	}
+	else
+	{
+		cout << "The input file has no seek table, so it will be decoded from the beginning." << endl;
+	}
+
+	// We can jump straight to the byte holding the first bit of the entry's symbol, so we go there,
+	// and decode from the bit inside of that byte where the symbol starts.
+	inputStream.clear();
+	inputStream.seekg(dataStart + bitOffset / 8);
+
+	decodeRange(dataLength - bitOffset / 8, bitOffset % 8, position, offset, end);
+
+	closeStreams(); // We've finished decoding the range, so we close our input and output streams.
+
+	printFinalInfo(); // We're done, so we can print the elapsed time and amount of bytes in and out.
+}
+
+void Huffman::decodeRange(unsigned long long dataLength, int firstBit, unsigned long long position, unsigned long long offset, unsigned long long end)
+{
+	// This method decodes symbols starting at the given bit of the next byte of the input
+	// stream, where the symbol at the given position of the original file starts. Symbols
+	// before the offset are thrown away, and we stop as soon as we have decoded the symbol
+	// before the end, so we never read more of the file than the range needs.
+	//
+	char character; // This variable will hold each character we read from the input stream.
+
+	unsigned short currentNode = 0; // Seek table entries always point at the start of a symbol, so we start at the root.
+
+	int bit = firstBit; // The bit of the current byte we are checking, counting from the left.
+
+	// While we still have symbols we want and the input stream successfully reads in a character,
+	while (position < end && dataLength > 0 && inputStream.get(character))
+	{
+		dataLength--; // We have one less byte of encoded bits left to read,
+
+		bytesIn++; // and we increment our bytes in counter since we have read a byte.
+
+		unsigned char byte = character;
+
+		for (; bit < 8; bit++) // Loop through the bits of the byte we haven't looked at yet,
+		{
+			// and navigate to the right child if the bit is on, or the left child if it is off.
+			currentNode = tables->children[currentNode][byte & (128 >> bit) ? 1 : 0];
+
+			if (currentNode >= HuffmanTables::LEAF) // If we reached a leaf, we've decoded the symbol at our position.
+			{
+				if (position >= offset) // If the symbol is inside of the range,
+				{
+					outputStream.put((char)(currentNode - HuffmanTables::LEAF)); // we write it to the output stream,
+
+					bytesOut++; // and increment our bytes out counter since we just wrote a byte.
+				}
+
+				position++; // We move on to the next position,
+
+				currentNode = 0; // and start back at the root of the tree.
+
+				if (position == end) // If that was the last symbol of the range,
+				{
+					return; // we're done.
+				}
+			}
+		}
+
+		bit = 0; // Every byte after the first one is checked from its first bit.
+	}
+
+	if (position < end && end != ULLONG_MAX) // If we ran out of encoded bits before the end of the range,
+	{
+		cout << "The range goes past the end of the file, so only part of it was decoded." << endl; // we let the user know.
+	}
+}
+
+void Huffman::decodeBlockRange(const HuffmanFormat::header& fileHeader, unsigned long long offset, unsigned long long end)
+{
+	// This method decodes the given range of a file that is split into blocks. Every block
+	// header says how many bytes of data the block has, so we can hop from one block to the
+	// next without decoding anything, only reading the tree builder of blocks that bring
+	// their own, since a later block may use it. The blocks that overlap the range are
+	// decoded from their first symbol, or for stored blocks, read straight from the offset.
+	//
+	unsigned int size;			// The amount of symbols in each block,
+	string sharedTree;			// the tree builder bytes of the shared tree,
+	string previousTree;		// and of the last block that brought its own tree.
+
+	if (fileHeader.originalLength == HuffmanFormat::UNKNOWN_LENGTH || !readBlockStart(size, sharedTree))
+	{
+		reportError("The input file has an invalid block.");
+
+		return;
+	}
+
+	unsigned long long position = 0; // The position in the original file of the first symbol of the block we're on
+
+	while (position < end)
+	{
+		unsigned char mode;				// How the block is stored,
+		unsigned long long dataLength;	// and how many bytes of data it has.
+
+		if (!readBlockHeader(mode, dataLength, previousTree))
+		{
+			reportError("The input file has an invalid block.");
+
+			return;
+		}
+
+		unsigned long long count = fileHeader.originalLength - position < size ? fileHeader.originalLength - position : size; // The amount of symbols in the block
+
+		unsigned long long blockEnd = position + count < end ? position + count : end; // Where the part of the range in this block ends
+
+		unsigned long long dataStart = inputStream.tellg(); // Where the data of the block starts
+
+		if (blockEnd > offset) // If the block has part of the range,
+		{
+			if (mode == HuffmanFormat::BLOCK_STORED) // and it is stored as is, every symbol is right where it was,
+			{
+				unsigned long long first = offset > position ? offset : position;
+
+				inputStream.seekg(dataStart + (first - position)); // so we jump straight to the first one we want
+
+				copyBytes(blockEnd - first); // and copy the part of the range.
+			}
+			else if (GetTables(mode == HuffmanFormat::BLOCK_SHARED_TREE ? sharedTree : previousTree) != nullptr) // Otherwise, we switch to its tree,
+			{
+				decodeRange(dataLength, 0, position, offset, blockEnd); // and decode it from its first symbol, throwing away the ones before the offset.
+			}
+			else
+			{
+				reportError("The input file has an invalid tree builder.");
+
+				return;
+			}
+		}
+
+		inputStream.clear(); // Either way, we go on to the next block.
+		inputStream.seekg(dataStart + dataLength);
+
+		position += count;
+	}
+}
+
+void Huffman::SetTableCache(string directory)
+{
+	// This method sets the directory of the table cache used when building trees from
+	// tree builders. An empty directory turns the cache off. The tables of the tree we
+	// have may be mapped from the old cache, so we get rid of the tree first.
+	//
+	destroyTree();
+
+	tableCache.reset(directory.empty() ? nullptr : new HuffmanTableCache(directory));
+}
+
+unsigned int Huffman::GetBlockSize() const
+{
+	// This method returns how many bytes of the input go into each block when encoding.
+	// Encoding in blocks switches between trees, so callers that keep instances around for
+	// the tree they have built need to know whether it will still be built afterwards.
+	//
+	return blockSize;
+}
+
+void Huffman::CopySettings(const Huffman& other)
+{
+	// This method gives us every setting of the given instance, so an instance made later,
+	// like one of the daemon's, encodes and decodes the same way as the one the options were
+	// given to. We get a table cache of our own in the same directory, since its mapped tables
+	// belong to whichever instance uses them.
+	//
+	SetTableCache(other.tableCache == nullptr ? "" : other.tableCache->GetDirectory());
+
+	seekInterval = other.seekInterval;
+	checksumEnabled = other.checksumEnabled;
+	verifyEnabled = other.verifyEnabled;
+	blockSize = other.blockSize;
+	sampleSize = other.sampleSize;
+}
+
+void Huffman::SetSeekInterval(unsigned int interval)
+{
+	// This method sets how many symbols apart the entries of the seek table
+	// are. Setting it to 0 turns the seek table off.
+	//
+	seekInterval = interval;
+}
+
+void Huffman::SetChecksum(bool enabled)
+{
+	// This method sets whether encoded files get the checksum of their input in
+	// the header, so decoding can tell if they were changed after encoding.
+	//
+	checksumEnabled = enabled;
+}
+
+void Huffman::SetVerify(bool enabled)
+{
+	// This method sets whether we decode what we encode while we encode it,
+	// to make sure every file we write decodes back to its input.
+	//
+	verifyEnabled = enabled;
+}
+
+void Huffman::SetBlockSize(unsigned int size)
+{
+	// This method sets how many bytes of the input go into each block when encoding.
+	// Each block is coded with whichever tree suits it best, so inputs that change
+	// along the way compress better. Setting it to 0 uses one tree for the whole input.
+	//
+	blockSize = size;
+}
+
+void Huffman::SetSampleSize(unsigned long long size)
+{
+	// This method sets about how many bytes of the input the tree is built from when
+	// encoding. Large inputs are then only read once more to encode them, instead of
+	// twice. Setting it to 0 counts every byte of the input, which is the default.
+	//
+	sampleSize = size;
+}
+
+void Huffman::writeHeader(bool stored)
+{
+	// This method writes the header of the output file. The flags say whether the
+	// input is stored as is rather than coded, and for coded files, whether a seek
+	// table will follow the encoded bits, and whether a checksum ends the header. A
+	// stored file doesn't need a seek table, since every byte of the original file is
+	// at a known spot.
+	//
+	HuffmanFormat::header fileHeader;
+
+	fileHeader.version = HuffmanFormat::VERSION; // We always write the newest version of the format,
+	fileHeader.originalLength = inputLength; // which has the length of the input, so decoders know where to stop.
+
+	if (stored) // If the input is going to be stored,
+	{
+		fileHeader.flags |= HuffmanFormat::FLAG_STORED; // we turn on its flag.
+	}
+	else if (!blocks.empty()) // Otherwise, if the input is split into blocks, we turn on their flag. Each block
+	{						  // starts with everything needed to skip over it, so there is no seek table.
+		fileHeader.flags |= HuffmanFormat::FLAG_BLOCKS;
+	}
+	else if (seekInterval != 0) // Otherwise, if we are going to write a seek table,
+	{
+		fileHeader.flags |= HuffmanFormat::FLAG_SEEK_TABLE; // we turn on its flag.
+	}
+
+	// If we are going to write a checksum, we turn on its flag as well. The checksum itself
+	// isn't known until the whole input has been read, so encodeInput fills it in later.
+	if (checksumEnabled)
+	{
+		fileHeader.flags |= HuffmanFormat::FLAG_CHECKSUM;
+	}
+
+	bytesOut += HuffmanFormat::writeHeader(outputStream, fileHeader); // Write the header, adding its size to our bytes out.
+}
+
+bool Huffman::readHeader(HuffmanFormat::header& fileHeader)
+{
+	// This method reads the header of the input file. Files written before the
+	// header existed don't have one, so we leave the given header with no flags
+	// and decode them just like before. If the file does have a header, but was
+	// written by a newer version of the program, we can't decode it, so we say
+	// so and return false.
+	//
+	if (!HuffmanFormat::readHeader(inputStream, fileHeader)) // If the file doesn't have a header,
+	{
+		return true; // there is nothing else to check.
+	}
+
+	bytesIn += HuffmanFormat::headerSize(fileHeader); // We read the header, so we add its size to our bytes in.
+
+	if (fileHeader.version == 0 || fileHeader.version > HuffmanFormat::VERSION) // If the file was written with a version we don't know,
+	{
+		reportError("Unsupported file version."); // we print that out,
+
+		return false; // and return false, since we can't decode it.
+	}
+
+	return true;
+}
+
+bool Huffman::getDataLength(const HuffmanFormat::header& fileHeader, unsigned long long& dataLength)
+{
+	// This method works out how many bytes of encoded bits there are, starting at the
+	// current position of the input stream. Normally, the encoded bits go until the end
+	// of the file, but if there is a seek table, they stop right where the table starts.
+	// We leave the input stream where we found it, so the caller can start decoding. If
+	// the seek table says it's bigger than what's left of the file, we return false.
+	//
+	streampos current = inputStream.tellg(); // Remember where we are,
+
+	inputStream.seekg(0, ios::end); // and go to the end of the file.
+
+	unsigned long long dataEnd = inputStream.tellg(); // Without a seek table, the encoded bits end at the end of the file.
+
+	bool valid = true; // Whether the seek table fits, if there is one
+
+	if (fileHeader.flags & HuffmanFormat::FLAG_SEEK_TABLE) // If there is a seek table, the encoded bits end where it starts.
+	{
+		unsigned long long entryCount;
+
+		valid = readSeekFooter(current, dataEnd, entryCount);
+	}
+
+	inputStream.clear();		// We clear any error flags from seeking around,
+	inputStream.seekg(current);	// and go back to where we were.
+
+	dataLength = valid ? dataEnd - current : 0;
+
+	return valid;
+}
+
+bool Huffman::readSeekFooter(unsigned long long dataStart, unsigned long long& tableStart, unsigned long long& entryCount)
+{
+	// This method reads the amount of entries from the footer at the very end of the file,
+	// skipping over the interval, and works out where the table starts from it. The count
+	// comes from the file, so before we use it, we make sure the footer and that many entries
+	// fit between the given start of the encoded bits and the end of the file. Otherwise,
+	// the table would start before the encoded bits, or even before the file, so it's corrupt
+	// and we return false.
+	//
+	inputStream.clear(); // We may have read to the end of the file already, so we clear the error flags first.
+
+	inputStream.seekg(0, ios::end);
+
+	unsigned long long fileEnd = inputStream.tellg();
+
+	if (fileEnd < dataStart || fileEnd - dataStart < (unsigned long long)HuffmanFormat::SEEK_FOOTER_SIZE) // If there isn't room for the footer,
+	{
+		return false; // the file is corrupt.
+	}
+
+	inputStream.seekg(-HuffmanFormat::SEEK_FOOTER_SIZE, ios::end);
+
+	HuffmanFormat::readNumber(inputStream, 4);
+
+	entryCount = HuffmanFormat::readNumber(inputStream, 8);
+
+	unsigned long long tableSize; // The size of the entries and the footer
+
+	// If the entries don't fit between the encoded bits and the footer, the file is corrupt.
+	if (!inputStream || !HuffmanFormat::seekTableSize(entryCount, fileEnd - dataStart, tableSize))
+	{
+		return false;
+	}
+
+	tableStart = fileEnd - tableSize; // Otherwise, the table starts that far before the end of the file.
+
+	return true;
+}
+
+unsigned long long Huffman::getInputLength()
+{
+	// This method works out how many bytes of the input stream are left, starting at its
+	// current position, for when we encode without reading the input first. We leave the
+	// input stream where we found it.
+	//
+	streampos current = inputStream.tellg(); // Remember where we are,
+
+	inputStream.seekg(0, ios::end); // and go to the end of the input.
+
+	unsigned long long end = inputStream.tellg();
+
+	inputStream.clear();		// We clear any error flags from seeking around,
+	inputStream.seekg(current);	// and go back to where we were.
+
+	return end > (unsigned long long)current ? end - current : 0;
+}
+
+void Huffman::truncateOutput(string path, unsigned long long length)
+{
+	// This method cuts the given file down to the given length. The file has to be closed
+	// already, so everything written to it has made it to the disk. Just like making room
+	// for the output, we do this the way each platform does it.
+	//
+	bool truncated = false; // Whether we were able to cut the file down
+
+#ifdef _WIN32
+	// On Windows, we move the end of the file back to the length.
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER size;
+
+		size.QuadPart = length;
+
+		truncated = SetFilePointerEx(file, size, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+
+		CloseHandle(file);
+	}
+#else
+	// Everywhere else, truncate cuts off everything past the length.
+	truncated = truncate(path.c_str(), (off_t)length) == 0;
+#endif
+
+	if (!truncated) // If we couldn't, the output may still be padded out to its full length, so we say so.
+	{
+		cout << "Unable to truncate the output file." << endl;
+	}
+}
+
+void Huffman::preallocateOutput(unsigned long long length)
+{
+	// This method makes room for the given amount of bytes of output before we start writing
+	// it, so the file system can hand out the space all at once instead of growing the file a
+	// little at a time. Decoding writes every byte in order anyway, so this is only a hint:
+	// if the space can't be set aside, we just write the output the way we always have.
+	//
+	if (outputPath.empty()) // If we aren't writing to a file,
+	{
+		if (outputString != nullptr) // but to a string,
+		{
+			outputString->reserve((size_t)length); // we make the string big enough up front.
+		}
+
+		return;
+	}
+
+#ifdef _WIN32
+	// On Windows, we move the end of the file out to the length, which sets aside the space without writing it.
+	HANDLE file = CreateFileA(outputPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER size;
+
+		size.QuadPart = length;
+
+		if (SetFilePointerEx(file, size, nullptr, FILE_BEGIN))
+		{
+			SetEndOfFile(file);
+		}
+
+		CloseHandle(file);
+	}
+#else
+	// Everywhere else, posix_fallocate sets aside the blocks for the whole file.
+	int file = open(outputPath.c_str(), O_WRONLY);
+
+	if (file >= 0)
+	{
+		posix_fallocate(file, 0, (off_t)length);
+
+		close(file);
+	}
+#endif
+}
+
+void Huffman::writeSeekTable()
+{
+	// This method writes the seek table entries recorded during encoding to the end of the
+	// output file, followed by a footer with the interval and the amount of entries. The
+	// footer is at the very end so decoders can find the table without reading the bits.
+	//
+	if (seekInterval == 0) // If we weren't asked for a seek table,
+	{
+		return; // there is nothing to write.
+	}
+
+	for (unsigned int i = 0; i < seekTable.size(); i++) // For every entry we recorded,
+	{
+		HuffmanFormat::writeNumber(outputStream, seekTable[i].first, 8);	// we write the symbol position
+		HuffmanFormat::writeNumber(outputStream, seekTable[i].second, 8);	// and the bit offset.
+	}
+
+	HuffmanFormat::writeNumber(outputStream, seekInterval, 4); // Then we write the footer: the interval,
+	HuffmanFormat::writeNumber(outputStream, seekTable.size(), 8); // and the amount of entries.
+
+	bytesOut += seekTable.size() * HuffmanFormat::SEEK_ENTRY_SIZE + HuffmanFormat::SEEK_FOOTER_SIZE; // Add everything we wrote to our bytes out.
+}
+
+void Huffman::writeTreeBuilder()
+{
+	// This method writes the tree builder bytes of the tree that is currently built
+	// to the output stream, so the exact same tree can be built again later.
+	//
+	outputStream.write(treeBuilder.data(), treeBuilder.size());
+
+	bytesOut += treeBuilder.size(); // We add the bytes we wrote to our bytes out.
+}
+
+void Huffman::writeBlocks()
+{
+	// This method writes the input as the blocks we planned. First comes the block size, so the
+	// decoder knows how many symbols each block has, and the tree builder of the shared tree,
+	// which is the tree that is currently built. Then each block gets a header with how it is
+	// stored and how many bytes of data it has, so it can be skipped over without decoding it,
+	// followed by its tree builder if it brings its own tree, and its data.
+	//
+	string sharedTree = treeBuilder;	// The tree builder bytes of the shared tree,
+	string previousTree;				// and of the last block that brought its own tree.
+
+	HuffmanFormat::writeNumber(outputStream, blockSize, HuffmanFormat::BLOCK_SIZE_LENGTH);
+
+	bytesOut += HuffmanFormat::BLOCK_SIZE_LENGTH;
+
+	writeTreeBuilder();
+
+	for (const block& current : blocks)
+	{
+		outputStream.put((char)current.mode); // We write the header of the block,
+
+		HuffmanFormat::writeNumber(outputStream, current.dataLength, HuffmanFormat::BLOCK_HEADER_SIZE - 1);
+
+		bytesOut += HuffmanFormat::BLOCK_HEADER_SIZE;
+
+		if (current.mode == HuffmanFormat::BLOCK_STORED) // and if the block is stored as is,
+		{
+			copyBytes(current.length); // we copy its bytes straight through.
+
+			continue;
+		}
+
+		if (current.mode == HuffmanFormat::BLOCK_NEW_TREE) // If it brings its own tree, its tree builder comes first.
+		{
+			outputStream.write(current.treeBuilder.data(), current.treeBuilder.size());
+
+			bytesOut += current.treeBuilder.size();
+
+			previousTree = current.treeBuilder;
+		}
+
+		// We switch to the tree the block is coded with, which is the new one if it brought one,
+		// and build its encoding table, so we can encode the block's bytes with it.
+		GetTables(current.mode == HuffmanFormat::BLOCK_SHARED_TREE ? sharedTree : previousTree);
+
+		buildEncodingTable();
+
+		encodeBytes(current.length);
+	}
+}
+
+bool Huffman::shouldStore()
+{
+	// This method checks whether coding the input would make it bigger than just storing it,
+	// using the counted frequencies and the codes of the tree that is currently built, which
+	// was either built from those frequencies or given to us in a tree file. Data that is already compressed
+	// or random uses every symbol about equally often, so its codes are all about 8 bits long,
+	// and the tree builder and padding make the file bigger than it started out.
+	//
+	unsigned long long total = countedLength; // The amount of bytes the frequencies were counted from
+
+	// If the frequencies were counted from a sample, every bit we work out from them stands for this many bits of the input.
+	double scale = countedLength != 0 ? (double)inputLength / countedLength : 1;
+
+	// First, we work out the entropy of the input, which is the fewest bits any code built from
+	// these frequencies could possibly use. If even that isn't smaller than the input, there's no
+	// need to build the encoding table to know coding won't pay off.
+	double entropyBits = 0;
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
+	{
+		if (frequencies[i] != 0) // A symbol that never appears doesn't add anything.
+		{
+			// A symbol that makes up p of the input needs at least -log2(p) bits each time it appears.
+			entropyBits -= frequencies[i] * log2((double)frequencies[i] / total);
+		}
+	}
+
+	if (entropyBits * scale / 8 + HuffmanFormat::TREE_BUILDER_SIZE >= inputLength) // If even the entropy plus the tree builder isn't smaller,
+	{
+		return true; // we should store the input.
+	}
+
+	// Otherwise, we work out exactly how many bits our codes would use, which is the length of
+	// each symbol's code times the amount of times it appears.
+	buildEncodingTable();
+
+	unsigned long long codedBits = 0;
+
+	for (int i = 0; i < AMOUNT_OF_CHARACTERS; i++)
+	{
+		codedBits += (unsigned long long)frequencies[i] * encodingTable[i].length();
+	}
+
+	// The coded file needs the tree builder, and the last byte gets rounded up with padding bits.
+	return (unsigned long long)(codedBits * scale + 7) / 8 + HuffmanFormat::TREE_BUILDER_SIZE >= inputLength;
+}
+
+void Huffman::copyBytes(unsigned long long length)
+{
+	// This method copies up to the given amount of bytes from the input stream straight
+	// to the output stream, stopping early if the input runs out. We copy in large chunks,
+	// so the stream buffers can hand whole chunks to the file or memory at once instead of
+	// going through them a byte at a time.
+	//
+	const static int CHUNK_SIZE = 65536; // The amount of bytes we copy at a time
+
+	vector<char> chunk(CHUNK_SIZE); // The memory we copy each chunk through
+
+	while (length > 0)
+	{
+		// We read a whole chunk, or whatever is left to copy if that's less.
+		inputStream.read(chunk.data(), length < CHUNK_SIZE ? (streamsize)length : CHUNK_SIZE);
+
+		streamsize read = inputStream.gcount(); // The amount of bytes we actually got
+
+		if (read == 0) // If we didn't get anything, the input has run out,
+		{
+			break; // so we're done.
+		}
+
+		outputStream.write(chunk.data(), read); // We write what we got,
+
+		bytesIn += read; // and add it to our bytes in
+		bytesOut += read; // and bytes out.
+
+		length -= read; // We have that much less left to copy.
+	}
+}
+
 void Huffman::printFinalInfo()
 {
 	// This method prints out the time elapsed and the bytes in from the
@@ -655,7 +2803,7 @@ void Huffman::printFinalInfo()
 	cout << formatUnsignedInt(bytesIn) << " bytes in / " << formatUnsignedInt(bytesOut) << " bytes out\n"; // Print the bytes in and out, formatted
 }
 
-string Huffman::formatUnsignedInt(unsigned int number)
+string Huffman::formatUnsignedInt(unsigned long long number)
 {
 	// This method formats the given unsigned integer by
 	// inserting commas into it, starting from the right of the string
@@ -685,6 +2833,18 @@ void Huffman::DisplayHelp()
 	cout << "-h|-?|-help - Prints out this help\n";
 	cout << "-e file1 [file2] - Encodes file1, placing the encrypted version into file2. If file2 is not specified, file2 will have the same name as file1, minus the extension, which will be .huf.\n";
 	cout << "-d file1 file 2 - Decodes file1, placing the decrypted version into file1.\n";
+	cout << "-r file1 file2 offset length - Decodes only length bytes of file1, starting at byte offset of the original file, placing them into file2.\n";
 	cout << "-t file1 [file2] - Creates a 510 byte tree-builder file for file1, and places it into file2.\n";
 	cout << "-et file1 file2 [file3] - Encodes file1 with the tree built from file2 and places it into file3. If file3 is not specified, the output file will have the same name as file1 with the .huf extension.\n";
+	cout << "-g file1 file2 [name] - Creates a C++ header in file2 with constexpr code and decoding tables for the tree builder file file1, in a struct with the given name (HuffmanCodebook if not specified), for use with FixedHuffmanCoder.\n";
+	cout << "-s socket [workers] - Runs in the background, servicing encode and decode requests on the Unix domain socket at the given path with the given amount of worker threads, until interrupted. The options other than --trees and --max-output apply to every request, just like they would to -e and -d.\n";
+	cout << "Options (can be placed anywhere after the flag):\n";
+	cout << "--cache=dir - Keeps the built tables of every tree read from a tree builder in the given directory, so files with a tree that was used before don't have to build it again.\n";
+	cout << "--index[=n] - When encoding, writes a seek table with an entry every n symbols (" << DEFAULT_SEEK_INTERVAL << " if n is not specified), so -r only has to decode the part of the file it needs.\n";
+	cout << "--sample[=n] - When encoding, builds the tree from about n bytes (" << DEFAULT_SAMPLE_SIZE << " if n is not specified) spread across the input instead of all of it, unless the input is small or the sample doesn't represent it.\n";
+	cout << "--blocks[=n] - When encoding, splits the input into blocks of n bytes, at least " << MIN_BLOCK_SIZE << " (" << DEFAULT_BLOCK_SIZE << " if n is not specified), and codes each one with the shared tree, the tree of the last block that had its own, or a new tree of its own, whichever is smallest.\n";
+	cout << "--trees=dir - With -s, lets clients encode with the tree files in the given directory, by name. Without it, encoding with a tree file is refused.\n";
+	cout << "--max-output=n - With -s, refuses requests whose response would be larger than n bytes (" << HuffmanDaemon::DEFAULT_MAX_OUTPUT_SIZE << " if not specified).\n";
+	cout << "--crc - When encoding, writes a CRC32C checksum of the input to the header, so decoding can tell if the file was changed or corrupted.\n";
+	cout << "--verify - When encoding, decodes the output in memory while it is written and makes sure it decodes back to the input.\n";
 }
\ No newline at end of file
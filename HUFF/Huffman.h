@@ -13,6 +13,17 @@
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "HuffmanFormat.h"
+#include "HuffmanTableCache.h"
+#include "HuffmanTreeBuilder.h"
+#include "MemoryBuffer.h"
 
 using namespace std;
 
@@ -22,14 +33,44 @@ public:
 	~Huffman();
 
 	void MakeTreeBuilder(string inputFile, string outputFile);	// Makes a tree builder file from the given input file in the specified output file
+	void MakeCodebookHeader(string treeFile, string outputFile, string name); // Makes a C++ header with constexpr code and decoding tables for the given tree builder file
 	void EncodeFile(string inputFile, string outputFile);		// Encodes the given input file into the given output file
 	void DecodeFile(string inputFile, string outputFile);		// Decodes the given input file into the given output file
 	void EncodeFileWithTree(string inputFile, string treeFile, string outputFile); // Encodes the given input file, using the given tree builder file, into the given output file
+	void DecodeRange(string inputFile, string outputFile, unsigned long long offset, unsigned long long length); // Decodes only the given range of bytes of the input file into the given output file
+	bool EncodeBuffer(const char* data, size_t size, string& output); // Encodes the given bytes into the given string
+	bool DecodeBuffer(const char* data, size_t size, string& output); // Decodes the given encoded bytes into the given string
+	bool EncodeBufferWithTree(const char* data, size_t size, const string& treeBuilder, string& output); // Encodes the given bytes, using the given tree builder bytes, into the given string
+	const HuffmanTables* GetTables(const string& treeBuilder); // Builds the tree for the given tree builder bytes if it isn't built, returning its tables, or nullptr if the bytes don't describe a tree
+	const string& GetTreeBuilder(); // Returns the tree builder bytes of the tree that is currently built, or an empty string if there is none
+	const string& GetError(); // Returns why the last operation failed, or an empty string if it didn't
+	unsigned int GetBlockSize() const; // Returns how many bytes each block the input is split into when encoding has, or 0 if it isn't split
+	void CopySettings(const Huffman& other); // Gives us the table cache and encoding settings of the given instance
+	void SetTableCache(string directory); // Sets the directory of the table cache used for trees built from tree builders, or an empty string for none
+	void SetSeekInterval(unsigned int interval); // Sets how many symbols apart seek table entries are written when encoding, or 0 for no seek table
+	void SetChecksum(bool enabled); // Sets whether the checksum of the input is written to the header when encoding
+	void SetVerify(bool enabled); // Sets whether encoded output is decoded in memory while it is written, to make sure it decodes to the input
+	void SetSampleSize(unsigned long long size); // Sets about how many bytes of large inputs the tree is built from when encoding, or 0 to count every byte
+	void SetBlockSize(unsigned int size); // Sets how many bytes each block the input is split into when encoding has, with a tree chosen for each one, or 0 for one tree for the whole input
 	void DisplayHelp(); // Displays information on how to use the program
+
+	// The amount of symbols between seek table entries when a seek table is asked for without an interval.
+	const static unsigned int DEFAULT_SEEK_INTERVAL = 16384;
+
+	// The amount of bytes the tree is built from when sampling is asked for without a size.
+	const static unsigned long long DEFAULT_SAMPLE_SIZE = 4194304;
+
+	// The amount of bytes in each block when blocks are asked for without a size.
+	const static unsigned int DEFAULT_BLOCK_SIZE = 262144;
+
+	// The smallest block size we encode with. A block that brings its own tree spends 510 bytes on
+	// it, and we keep a kilobyte of counts for every block until we've planned them, so smaller
+	// blocks never pay off.
+	const static unsigned int MIN_BLOCK_SIZE = 4096;
 private:
 	struct treenode {
 		unsigned char symbol = NULL;	// The symbol of the node
-		unsigned int weight = 0;		// The weight of the node (amount of times the character appears in a file)
+		unsigned long long weight = 0;	// The weight of the node (amount of times the character appears in a file)
 		treenode* leftChild = nullptr;	// A pointer to the left child of the node
 		treenode* rightChild = nullptr;	// A pointer to the right child of the node
 	};
@@ -38,28 +79,120 @@ private:
 	//  of a file can range from 0 to 255, so there are 256 different possibilities.
 	const static int AMOUNT_OF_CHARACTERS = 256;
 
+	// The amount of bits the decoding table of a codebook header looks up at once. Its 256 entries
+	// cover every code of 8 bits or less, and longer codes are finished a bit at a time from there.
+	const static int CODEBOOK_TABLE_BITS = 8;
+
+	const static int SAMPLE_BLOCK_SIZE = 65536;		// The amount of bytes in each block of a sample, so every read of the input is a large one
+	constexpr static double MAX_SAMPLE_LOSS = 0.01;	// The largest estimated loss of compression ratio we accept from building the tree from a sample
+	constexpr static double MAX_SAMPLE_DRIFT = 0.02; // The largest difference in average code length we accept between the two halves of a sample
+
+	struct block {
+		unsigned long long length = 0;	// The amount of bytes of the input in the block
+		unsigned char mode = 0;			// How the block will be stored, one of the BLOCK_ constants of HuffmanFormat
+		unsigned long long dataLength = 0; // The amount of bytes the block takes up stored that way, not counting its header
+		string treeBuilder;				// The tree builder bytes of the block's own tree, only kept if it brings it
+	};
+
+	// What we need to know about a block to plan how to store it, which is only kept until we have.
+	// A block is never bigger than MAX_BLOCK_SIZE, so its frequencies always fit in an unsigned int.
+	struct blockcounts {
+		unsigned int frequencies[AMOUNT_OF_CHARACTERS] = {}; // The amount of times each character appears in the block
+		unsigned long long newTreeBits = 0; // The amount of bits the block takes up coded with its own tree
+	};
+
+	// The blocks read but not counted yet, and the buffers they were read into, shared by the
+	// threads that count blocks. Each buffer is either free, or holds a block waiting to be counted.
+	struct countingqueue {
+		mutex queueMutex;					// Guards everything below
+		condition_variable changed;			// Wakes the counting threads when a block is read, and the reader when a buffer is free
+		vector<vector<char>> buffers;		// The memory each block is read into
+		queue<size_t> freeBuffers;			// The buffers that can be read into
+		queue<pair<size_t, size_t>> ready;	// The buffer and index of every block read but not being counted yet
+		vector<size_t> lengths;				// The amount of bytes read into each buffer
+		bool finished = false;				// Whether every block has been read, so the threads should stop once the ready ones run out
+	};
+
 	treenode* nodes[AMOUNT_OF_CHARACTERS];		// An array of node pointers used to build the Huffman tree and encode/decode files.
 	string encodingTable[AMOUNT_OF_CHARACTERS];	// A string array containing the encoding bits for each type of character
-	string paddingBits;		// A string referring to padding bits that can be written at the end of a byte if extra bits are needed.
-	ifstream inputStream;	// An input file stream used for the input file that will be encoded/decoded
-	ofstream outputStream;	// An output file stream used for the file that will be written to
-	unsigned int bytesIn;	// An unsigned integer that keeps track of the amount of bytes read in, so it can be displayed at the end of the operation.
-	unsigned int bytesOut;	// An unsigned integer that keeps track of the amount of bytes written out, so it can be displayed at the end of the operation.
+	unsigned long long frequencies[AMOUNT_OF_CHARACTERS];	// The amount of times each character appeared in the input the last time a tree was built from it
+	HuffmanTables builtTables;	// The tables built from the tree of nodes that was built last
+	const HuffmanTables* tables;	// The tables of the tree that is currently built, either our own or ones mapped from the table cache
+	unique_ptr<HuffmanTableCache> tableCache; // The table cache used when building trees from tree builders, if any
+	bool encodingTableBuilt;	// Whether the encoding table has been built for the tree that is currently built
+	string treeBuilder;		// The tree builder bytes of the tree that is currently built, so an identical tree doesn't have to be built again
+	filebuf inputFileBuffer;	// The file buffer the input stream reads from when the input is a file
+	filebuf outputFileBuffer;	// The file buffer the output stream writes to when the output is a file
+	istream inputStream;	// An input stream used for the input file or memory that will be encoded/decoded
+	ostream outputStream;	// An output stream used for the file or memory that will be written to
+	string outputPath;		// The path of the output file, or an empty string when the output is memory
+	StringOutputBuffer* outputString; // The string buffer the output stream writes to when the output is memory, or nullptr
+	unsigned long long bytesIn;		// Keeps track of the amount of bytes read in, so it can be displayed at the end of the operation.
+	unsigned long long bytesOut;	// Keeps track of the amount of bytes written out, so it can be displayed at the end of the operation.
+	unsigned long long inputLength;	// The amount of bytes in the input being encoded, which is written to the header
+	unsigned long long countedLength; // The amount of bytes of the input the frequencies were counted from, which is less than the input length for a sample
+	unsigned long long sampleSize;	// About how many bytes of the input the tree should be built from, or 0 to count every byte
+	string samplingReport;			// What happened when the tree was last built from a sample, or an empty string if it wasn't
+	unsigned int blockSize;			// The amount of bytes in each block the input is split into when encoding, or 0 for no blocks
+	vector<block> blocks;			// The blocks of the input being encoded and how each one will be stored, or none if it isn't split into blocks
+	vector<blockcounts> blockCounts; // The counts of each block, from when they are counted until they are planned
+	unsigned long long symbolsLeft;	// The amount of symbols left to decode before the end of the original file
 	chrono::high_resolution_clock::time_point start; // A point of time that will represent the very beginning of the operation
+	unsigned int seekInterval;	// The amount of symbols between seek table entries, or 0 if no seek table should be written
+	vector<pair<unsigned long long, unsigned long long>> seekTable; // The symbol position and bit offset of every seek table entry recorded during encoding
+	bool checksumEnabled;	// Whether the checksum of the input should be written to the header when encoding
+	bool verifyEnabled;		// Whether encoded output should be decoded in memory as it is written, and checked against the input
+	string verificationError; // Why the output of the last encoding didn't decode to its input, or an empty string if it did or wasn't checked
+	string lastError;		// Why the last operation failed, or an empty string if it didn't
 
 	void traverseDestruct(treenode* p); // Traverses through the given node and deletes its children recursively as well as itself
+	void destroyTree(); // Deletes every node of the tree that is currently built, so a different one can be built
+	void beginOperation(); // Resets the counters and starting time so one instance can run several operations
 	bool openStreams(string inputFile, string outputFile); // Opens the input and output streams for the given input and output files
+	void attachStreams(streambuf* input, streambuf* output); // Points the input and output streams at the given stream buffers
 	void closeStreams(); // Closes out both the input and output streams
-	int getIndexOfSmallestNode(int skipIndex); // Returns the smallest node index in the array, skipping the given index
+	void reportError(const string& message); // Records why the operation failed, printing it out unless the output is memory
+	void encode(); // Encodes the input stream into the output stream, building the tree from the input stream
+	bool decode(); // Decodes the input stream into the output stream, returning false if it can't be decoded or doesn't match its checksum
+	bool decodeContents(const HuffmanFormat::header& fileHeader); // Decodes whatever follows the given header of the input stream into the output stream, returning false if it can't be decoded
+	bool encodeWithTree(istream& treeStream); // Encodes the input stream into the output stream, building the tree from the given tree builder stream, returning false if it is invalid
 	void buildTree(bool incrementBytesIn); // Builds the tree of nodes by reading the input file and determining frequencies and writes the combinations of nodes to the output stream
-	void buildTreeFromTreeBuilder(ifstream& stream, bool writeToOutput); // Builds the tree of nodes by combining nodes based on the given stream.
-	void buildEncodingTable(); // Builds the encoding table, which is used to encode each character in a file
+	void countFrequencies(bool incrementBytesIn); // Counts the frequency of each character and the length of the input by reading all of it
+	bool buildTreeFromSample(); // Builds the tree of nodes from blocks spread across the input, returning false if the input is too small or the sample doesn't represent it well enough
+	void buildTreeFromFrequencies(); // Builds the tree of nodes by combining the two smallest nodes, weighted by the frequencies, until only the root is left
+	void countBlocks(); // Splits the input into blocks and counts the frequencies of each one, and of the whole input, on several threads
+	static void countingLoop(countingqueue& queue, vector<blockcounts>& counts); // Counts the blocks of the given queue as they are read, until every one has been
+	static void countBlock(const char* data, size_t length, blockcounts& target); // Counts the frequencies of the given block, which starts at the given data, and works out its bits with its own tree
+	static vector<HuffmanTreeBuilder::merge> buildBlockTree(const blockcounts& counts); // Returns the combinations that build the own tree of the block with the given counts
+	bool planBlocks(); // Chooses how to store each block from the exact amount of bytes each way would take, dropping the blocks if they don't pay off, and returning false if storing the whole input is smaller
+	void writeBlocks(); // Writes the block size, the tree builder of the tree that is currently built, and every block the way it was planned
+	bool decodeBlocks(const HuffmanFormat::header& fileHeader); // Decodes the blocks of a file with the FLAG_BLOCKS flag, returning false if it is cut off or corrupt
+	bool readBlockStart(unsigned int& size, string& sharedTree); // Reads the block size and shared tree builder that come before the first block, returning false if they are invalid
+	bool readBlockHeader(unsigned char& mode, unsigned long long& dataLength, string& previousTree); // Reads the header of the next block, and its tree builder if it has one, returning false if it is invalid
+	void decodeBlockRange(const HuffmanFormat::header& fileHeader, unsigned long long offset, unsigned long long end); // Decodes the given range of a file with the FLAG_BLOCKS flag, skipping over the blocks outside of it
+	bool buildTreeFromTreeBuilder(istream& stream); // Builds the tree of nodes by combining nodes based on the given stream, returning false if it doesn't describe a tree
+	void buildTables(); // Builds the encoding and decoding tables from the tree of nodes that was just built
+	void buildEncodingTable(); // Builds the encoding table, which is used to encode each character in a file, from the tables
 	void buildEncodingTable(treenode* node, string currentPath); // Recursively builds encoding table by starting at the given node and traversing through its children
-	void decodeBytes(); // Decodes the bytes of the input file
+	void encodeInput(bool stored); // Writes the input stream to the output stream with the tree that is currently built, or as is if it should be stored, checksumming and verifying it if asked to
+	void writeHeader(bool stored); // Writes the header of the output file, with flags for how the input is stored and the optional sections that will be written
+	void writeTreeBuilder(); // Writes the tree builder bytes of the tree that is currently built to the output stream
+	bool shouldStore(); // Checks whether coding the input with the tree that is currently built would make it bigger than just storing it, based on the counted frequencies
+	void copyBytes(unsigned long long length = ULLONG_MAX); // Copies up to the given amount of bytes from the input stream straight to the output stream
+	bool readHeader(HuffmanFormat::header& fileHeader); // Reads the header of the input file if it has one, returning false if the file can't be decoded
+	bool getDataLength(const HuffmanFormat::header& fileHeader, unsigned long long& dataLength); // Gets the amount of encoded bytes between the current position of the input stream and the end of the encoded bits, returning false if the seek table doesn't fit
+	bool readSeekFooter(unsigned long long dataStart, unsigned long long& tableStart, unsigned long long& entryCount); // Reads the seek table footer and gets where the table starts, returning false if it doesn't fit after the given start of the encoded bits
+	unsigned long long getInputLength(); // Returns the amount of bytes between the current position of the input stream and its end
+	void preallocateOutput(unsigned long long length); // Makes room for the given amount of bytes of output before any of it is written
+	static void truncateOutput(string path, unsigned long long length); // Cuts the given closed output file down to the given length, after decoding it failed partway through
+	bool decodeBytes(unsigned long long dataLength, unsigned long long symbolCount); // Decodes up to the given amount of bytes of the input file, stopping after the given amount of symbols, returning false if the input ran out first
+	void decodeRange(unsigned long long dataLength, int firstBit, unsigned long long position, unsigned long long offset, unsigned long long end); // Decodes symbols starting at the given bit, writing only those that fall within the range
+	void writeSeekTable(); // Writes the recorded seek table entries and the seek table footer to the output file
+	unsigned short buildDecodingTable(treenode* node, unsigned short& nextIndex); // Numbers the internal nodes under the given node, filling in their rows of the decoding table, and returns the node's number
 	void encodeBits(unsigned char& outputCharacter, int& currentBit, string& bits); // Encodes the given bits into the output file
-	void encodeBytes(); // Encodes the bytes of the input file
-	void navigateTree(unsigned char byte, int bitToCheck, treenode*& node); // Navigates through the tree by checking the given bit and navigating to the left and right child of the given node
+	void encodeBytes(unsigned long long length = ULLONG_MAX); // Encodes up to the given amount of bytes of the input file
+	void navigateTree(unsigned char byte, int bitToCheck, unsigned short& node); // Navigates through the tree by checking the given bit and navigating to the left and right child of the given node
 	void printFinalInfo(); // Prints the final information after the operation ran, like the time elapsed and bytes in and out
-	string formatUnsignedInt(unsigned int number); // Formats an unsigned integer by inserting commas into it, returning a string
+	string formatUnsignedInt(unsigned long long number); // Formats an unsigned integer by inserting commas into it, returning a string
 	bool isLeaf(treenode* node); // Checks if the given node is a leaf
 };
\ No newline at end of file
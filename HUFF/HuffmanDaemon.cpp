@@ -0,0 +1,758 @@
+//==============================================================================================
+// File: HuffmanDaemon.cpp - Huffman daemon implementation
+// c.f.: HuffmanDaemon.h
+//
+// This class keeps the program running in the background, listening on a Unix domain socket
+// for encode and decode requests, so callers don't have to start a new process for every file.
+// Connected clients are watched by one thread, and every request they send is serviced by
+// whichever thread of a pool of workers is free. Each worker keeps its own Huffman
+// instances with their trees and encoding tables already built, so requests that use a tree
+// the worker has seen before skip building it entirely.
+//
+// Every request and response is a frame: a 4 byte length, least significant byte first,
+// followed by that many bytes. A request frame starts with one of the REQUEST_ bytes, and a
+// response frame starts with one of the STATUS_ bytes, followed by the payload.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "HuffmanDaemon.h"
+
+#ifndef _WIN32
+// Set by the signal handler when we are asked to stop. Signal handlers can't safely touch
+// anything else, so the listener checks this every time it wakes up.
+static volatile sig_atomic_t stopRequested = 0;
+
+// The write end of the wake pipe while the daemon is running, or -1. The handler writes a byte to it,
+// so a signal that arrives right before the listener starts waiting still wakes it up.
+static volatile sig_atomic_t signalPipe = -1;
+
+static void requestStop(int)
+{
+	int savedErrno = errno; // Writing can change errno, which the code we interrupted may be about to look at.
+
+	stopRequested = 1;
+
+	if (signalPipe >= 0 && write(signalPipe, "", 1) < 0)
+	{
+	}
+
+	errno = savedErrno;
+}
+#endif
+
+HuffmanDaemon::HuffmanDaemon(string socketPath, unsigned int workerCount) : treeFiles(MAX_TREE_FILES)
+{
+	// The constructor. We just need to intialize all of our member variables. We always
+	// want at least one worker, otherwise nobody would ever service a client.
+	//
+	this->socketPath = socketPath;
+
+	this->workerCount = workerCount == 0 ? 1 : workerCount;
+
+	stopping = false; // We haven't started yet, so we certainly aren't stopping.
+
+	maxOutputSize = DEFAULT_MAX_OUTPUT_SIZE;
+
+	settings = nullptr; // Until we are told otherwise, every instance keeps the default settings.
+}
+
+void HuffmanDaemon::SetTreeDirectory(string directory)
+{
+	// This method sets the directory tree files are read from. Clients only ever give us the
+	// name of a tree file, never a path, so they can't make us read anything outside of it.
+	// Without a directory, we refuse to encode with tree files at all.
+	//
+	treeDirectory = directory;
+}
+
+void HuffmanDaemon::SetSettings(const Huffman* settings)
+{
+	// This method sets the instance whose settings every instance of the workers copies when it's
+	// made, so requests are encoded and decoded with the same options a file given to the program
+	// would be. Workers only ever read it, so they can share it without any locking.
+	//
+	this->settings = settings;
+}
+
+void HuffmanDaemon::SetMaxOutputSize(unsigned long long size)
+{
+	// This method sets the largest response payload we send. Decoding can make a payload
+	// many times bigger, so this is what keeps a request from making us build, and send,
+	// more than we want to. It can't be more than a frame length can describe.
+	//
+	maxOutputSize = size < MAX_OUTPUT_LIMIT ? size : MAX_OUTPUT_LIMIT;
+}
+
+bool HuffmanDaemon::Run()
+{
+	// This method sets up the socket, starts the workers, and then watches the socket and every
+	// idle client at once with poll. New clients are accepted, and a client that sends something
+	// is handed to the workers, which service one request and hand it back. That way a worker is
+	// only ever busy with a request, never with a client that is just sitting there, so any amount
+	// of connected clients can share the workers. When the process is interrupted, we stop taking
+	// requests, shut down the ones being serviced, and wait for the workers to finish up.
+	//
+#ifdef _WIN32
+	cout << "Daemon mode is only supported on systems with Unix domain sockets." << endl;
+
+	return false;
+#else
+	stopRequested = 0; // Whoever stopped the last run, if there was one, didn't stop this one.
+
+	sockaddr_un address; // The address of our socket, which is just its path
+
+	memset(&address, 0, sizeof(address));
+
+	address.sun_family = AF_UNIX;
+
+	if (socketPath.length() >= sizeof(address.sun_path)) // If the path won't fit in the address,
+	{
+		cout << "Socket path is too long." << endl; // we can't listen on it.
+
+		return false;
+	}
+
+	strcpy(address.sun_path, socketPath.c_str());
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0); // Create the socket we will accept clients on.
+
+	if (listener < 0)
+	{
+		cout << "Unable to create socket." << endl;
+
+		return false;
+	}
+
+	unlink(socketPath.c_str()); // A daemon that didn't shut down cleanly may have left its socket file behind, so we remove it.
+
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) // If we can't listen on the path,
+	{
+		cout << "Unable to listen on " << socketPath << "." << endl; // we say so,
+
+		close(listener); // and clean up the socket.
+
+		return false;
+	}
+
+	if (pipe(wakePipe) < 0) // We also need the pipe that wakes us up,
+	{
+		cout << "Unable to create wake pipe." << endl;
+
+		close(listener);
+
+		return false;
+	}
+
+	// and none of these can ever block us: a client that gives up between poll and accept shouldn't
+	// leave us stuck in accept, and a full pipe already has a wake up waiting in it.
+	fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+	fcntl(wakePipe[0], F_SETFL, fcntl(wakePipe[0], F_GETFL) | O_NONBLOCK);
+	fcntl(wakePipe[1], F_SETFL, fcntl(wakePipe[1], F_GETFL) | O_NONBLOCK);
+
+	// A client that disconnects while we are writing to it would normally kill the whole process
+	// with SIGPIPE, so we ignore it and let the write fail instead. SIGINT and SIGTERM write to the
+	// wake pipe, so they wake up poll even if they arrive right before we call it.
+	signal(SIGPIPE, SIG_IGN);
+
+	signalPipe = wakePipe[1];
+
+	struct sigaction stopAction;
+
+	memset(&stopAction, 0, sizeof(stopAction));
+
+	stopAction.sa_handler = requestStop;
+
+	sigaction(SIGINT, &stopAction, nullptr);
+	sigaction(SIGTERM, &stopAction, nullptr);
+
+	vector<thread> workers; // The worker threads servicing requests
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		workers.push_back(thread(&HuffmanDaemon::workerLoop, this));
+	}
+
+	cout << "Listening on " << socketPath << " with " << workerCount << " workers." << endl;
+
+	vector<int> idleClients; // The clients that aren't waiting for or being serviced by a worker
+
+	vector<pollfd> watched; // What we wait on: the wake pipe, the socket, and every idle client
+
+	while (!stopRequested) // Until we are asked to stop,
+	{
+		watched.clear();
+
+		watched.push_back({ wakePipe[0], POLLIN, 0 });
+		watched.push_back({ listener, POLLIN, 0 });
+
+		for (int client : idleClients)
+		{
+			watched.push_back({ client, POLLIN, 0 });
+		}
+
+		if (poll(watched.data(), watched.size(), -1) < 0) // we wait for something to happen.
+		{
+			if (errno == EINTR) // If we were interrupted,
+			{
+				continue; // we go back and check if we should stop.
+			}
+
+			cout << "Unable to wait for clients." << endl; // Otherwise, something is wrong,
+
+			break; // so we stop.
+		}
+
+		if (watched[0].revents != 0) // If we were woken up, we empty the pipe, so the next wake up is a new one.
+		{
+			char drained[64];
+
+			while (read(wakePipe[0], drained, sizeof(drained)) > 0)
+			{
+			}
+		}
+
+		{
+			lock_guard<mutex> lock(clientsMutex);
+
+			idleClients.clear();
+
+			for (size_t i = 2; i < watched.size(); i++)
+			{
+				if (watched[i].revents != 0) // If a client sent something, or hung up, a worker takes care of it,
+				{
+					readyClients.push(watched[i].fd);
+
+					clientsAvailable.notify_one();
+				}
+				else // and otherwise, it stays idle.
+				{
+					idleClients.push_back(watched[i].fd);
+				}
+			}
+
+			// The clients the workers are done with are idle again, until they send their next request.
+			idleClients.insert(idleClients.end(), returnedClients.begin(), returnedClients.end());
+
+			returnedClients.clear();
+		}
+
+		if (watched[1].revents != 0) // If a client is connecting,
+		{
+			int client = accept(listener, nullptr, nullptr); // we accept it.
+
+			if (client >= 0)
+			{
+				// Some systems hand out sockets that inherit our non blocking flag, but workers want to wait on them,
+				// only for so long, so a client that stops partway through a frame can't hold onto a worker forever.
+				fcntl(client, F_SETFL, fcntl(client, F_GETFL) & ~O_NONBLOCK);
+
+				timeval timeout = { CLIENT_TIMEOUT_SECONDS, 0 };
+
+				setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+				setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+				idleClients.push_back(client); // It's idle until it sends its first request.
+			}
+			else if (errno != EINTR && errno != ECONNABORTED && errno != EAGAIN && errno != EWOULDBLOCK) // If it failed for a reason other than the client giving up,
+			{
+				cout << "Unable to accept client." << endl; // something is wrong with the socket,
+
+				break; // so we stop.
+			}
+		}
+	}
+
+	{
+		lock_guard<mutex> lock(clientsMutex);
+
+		stopping = true; // We tell the workers we are stopping,
+
+		for (int client : activeClients) // and shut down every client being serviced, which wakes up workers
+		{
+			shutdown(client, SHUT_RDWR); // waiting to read from them. The worker still closes the socket itself.
+		}
+
+		clientsAvailable.notify_all(); // We also wake up every worker waiting for a client.
+	}
+
+	for (unsigned int i = 0; i < workers.size(); i++) // Now we wait for every worker to finish up.
+	{
+		workers[i].join();
+	}
+
+	while (!readyClients.empty()) // Any clients nobody got to are just closed,
+	{
+		close(readyClients.front());
+
+		readyClients.pop();
+	}
+
+	for (int client : returnedClients) // along with the ones that were handed back,
+	{
+		close(client);
+	}
+
+	for (int client : idleClients) // and the idle ones.
+	{
+		close(client);
+	}
+
+	signalPipe = -1; // Signals can't use the pipe anymore,
+
+	close(wakePipe[0]); // so we close it,
+	close(wakePipe[1]);
+
+	close(listener); // close our socket,
+
+	unlink(socketPath.c_str()); // and remove its file, since nobody is listening on it anymore.
+
+	return true;
+#endif
+}
+
+void HuffmanDaemon::Stop()
+{
+	// This method asks Run to stop, the same way the signal handler does, for whoever runs
+	// us on a thread of their own rather than as the whole process.
+	//
+#ifndef _WIN32
+	requestStop(0);
+#endif
+}
+
+#ifndef _WIN32
+void HuffmanDaemon::workerLoop()
+{
+	// This method is what every worker thread runs. We wait for a client with a request waiting,
+	// service that one request, and hand the client back to the listener, which gives it to
+	// whichever worker is free when it sends its next one. Our Huffman instances live on our own
+	// stack, so no other worker ever touches them and they don't need any locking.
+	//
+	warmtrees warmTrees(WARM_TREES_PER_WORKER); // Instances whose trees are built, for decoding and encoding with a tree file
+
+	Huffman scratch; // An instance for plain encoding, which builds a new tree from every payload, and for payloads with no tree or several
+
+	applySettings(scratch);
+
+	// The request and response strings are kept between requests, so once they are big
+	// enough we stop allocating memory for them.
+	string request; // The body of the current request frame
+	string response; // The payload of the current response frame
+
+	while (true)
+	{
+		int client; // The client we are going to service
+
+		{
+			unique_lock<mutex> lock(clientsMutex);
+
+			// We wait until there is a client for us or we are stopping.
+			clientsAvailable.wait(lock, [this] { return stopping || !readyClients.empty(); });
+
+			if (stopping) // If we are stopping,
+			{
+				return; // we're done.
+			}
+
+			client = readyClients.front(); // Otherwise, we take the next client off of the queue,
+
+			readyClients.pop();
+
+			activeClients.insert(client); // and remember that we are servicing it.
+		}
+
+		bool keep = serveRequest(client, request, response, warmTrees, scratch); // We service its request.
+
+		{
+			lock_guard<mutex> lock(clientsMutex);
+
+			activeClients.erase(client); // We aren't servicing the client anymore,
+
+			if (keep && !stopping) // so if it is still there, and we aren't stopping,
+			{
+				returnedClients.push_back(client); // we hand it back to the listener.
+
+				client = -1;
+			}
+		}
+
+		if (client < 0)
+		{
+			wakeListener(); // The listener has to start watching the client again.
+		}
+		else
+		{
+			close(client); // Otherwise, we close it.
+		}
+	}
+}
+
+bool HuffmanDaemon::serveRequest(int client, string& request, string& response, warmtrees& warmTrees, Huffman& scratch)
+{
+	// This method reads a request frame from the client, handles it, and sends back a response
+	// frame. If the client disconnected, sent something we can't handle, or took too long, we
+	// return false, so the client gets closed.
+	//
+	unsigned char lengthBytes[4]; // The length at the start of the frame
+
+	if (!readFully(client, (char*)lengthBytes, sizeof(lengthBytes))) // If the client disconnected,
+	{
+		return false; // we're done with it.
+	}
+
+	unsigned int length = lengthBytes[0] | lengthBytes[1] << 8 | lengthBytes[2] << 16 | (unsigned int)lengthBytes[3] << 24;
+
+	if (length == 0 || length > MAX_FRAME_SIZE) // If the frame has no request in it or is too large,
+	{
+		sendResponse(client, STATUS_ERROR, "Invalid frame length."); // we tell the client,
+
+		return false; // and give up on it, since we have no idea where the next frame would start.
+	}
+
+	request.resize(length); // Make room for the body,
+
+	if (!readFully(client, &request[0], length)) // and read it straight into the string.
+	{
+		return false;
+	}
+
+	unsigned char status = handleRequest(request, response, warmTrees, scratch); // Handle the request,
+
+	return sendResponse(client, status, response); // and send back the response.
+}
+
+void HuffmanDaemon::wakeListener()
+{
+	// This method wakes the listener up by writing a byte to the wake pipe. If the
+	// pipe is full, a wake up is already waiting, so it doesn't matter if this fails.
+	//
+	if (write(wakePipe[1], "", 1) < 0)
+	{
+	}
+}
+
+unsigned char HuffmanDaemon::handleRequest(const string& request, string& response, warmtrees& warmTrees, Huffman& scratch)
+{
+	// This method handles one request, making sure the response fits the output limit. Before we
+	// decode anything, we work out how big the output could be: the header says exactly, if it
+	// knows, and otherwise every byte of the payload can hold at most 8 symbols. If that's over the
+	// limit, we refuse the request without decoding it. Encoding can't be known up front, so we
+	// check the response once we have it, and send an error instead if it's too big.
+	//
+	if (request[0] == REQUEST_DECODE) // If we are decoding,
+	{
+		HuffmanFormat::header fileHeader;
+
+		unsigned long long outputBound = (request.size() - 1) * 8ULL; // the output can't be bigger than this,
+
+		// unless the header says exactly how big it is.
+		if (HuffmanFormat::readHeader(request.data() + 1, request.size() - 1, fileHeader) && fileHeader.originalLength != HuffmanFormat::UNKNOWN_LENGTH)
+		{
+			outputBound = fileHeader.originalLength;
+		}
+
+		if (outputBound > maxOutputSize) // If it could be too big,
+		{
+			response = "The output would be larger than the output limit."; // we don't decode it.
+
+			return STATUS_ERROR;
+		}
+	}
+
+	unsigned char status = runRequest(request, response, warmTrees, scratch);
+
+	if (status == STATUS_OK && response.size() > maxOutputSize) // If the response turned out too big,
+	{
+		response = "The output is larger than the output limit."; // we send an error instead.
+
+		return STATUS_ERROR;
+	}
+
+	return status;
+}
+
+unsigned char HuffmanDaemon::runRequest(const string& request, string& response, warmtrees& warmTrees, Huffman& scratch)
+{
+	// This method does what the request asks for, based on its first byte. The Huffman instances read the
+	// payload straight out of the request string and write straight into the response string,
+	// so the bytes are never copied between the socket and the encoder or decoder. If they fail,
+	// the response is why, which they keep for us instead of printing it.
+	//
+	unsigned char operation = request[0]; // The first byte says what to do,
+
+	const char* payload = request.data() + 1; // and the payload is everything after it.
+
+	size_t payloadSize = request.size() - 1;
+
+	if (operation == REQUEST_ENCODE) // If we are encoding, the tree is built from the payload,
+	{
+		return finishRequest(scratch, scratch.EncodeBuffer(payload, payloadSize, response), response); // so there is nothing warm to use.
+	}
+	else if (operation == REQUEST_DECODE) // If we are decoding,
+	{
+		HuffmanFormat::header fileHeader; // the header tells us where the tree builder is, if there is one.
+
+		bool hasHeader = HuffmanFormat::readHeader(payload, payloadSize, fileHeader);
+
+		if (hasHeader && (fileHeader.flags & HuffmanFormat::FLAG_STORED)) // If the payload is stored rather than coded,
+		{
+			// there is no tree, so there is nothing warm to use.
+			return finishRequest(scratch, scratch.DecodeBuffer(payload, payloadSize, response), response);
+		}
+
+		if (hasHeader && (fileHeader.flags & HuffmanFormat::FLAG_BLOCKS)) // If the payload is split into blocks,
+		{
+			// the decoder switches to whichever tree each block uses, so an instance kept for the shared tree
+			// would end up with some other tree built. The scratch instance doesn't promise to have any tree.
+			return finishRequest(scratch, scratch.DecodeBuffer(payload, payloadSize, response), response);
+		}
+
+		// Otherwise, the tree builder comes right after the header, if there is one. We use it to
+		// find a worker instance that already has the tree built.
+		size_t treeBuilderStart = hasHeader ? HuffmanFormat::headerSize(fileHeader) : 0;
+
+		if (payloadSize < treeBuilderStart + HuffmanFormat::TREE_BUILDER_SIZE) // If the payload is too short to have a tree builder,
+		{
+			response = "Input is too short to decode."; // we can't decode it.
+
+			return STATUS_ERROR;
+		}
+
+		string treeBuilder(payload + treeBuilderStart, HuffmanFormat::TREE_BUILDER_SIZE);
+
+		Huffman* huffman = findWarmTree(treeBuilder, warmTrees);
+
+		return finishRequest(*huffman, huffman->DecodeBuffer(payload, payloadSize, response), response);
+	}
+	else if (operation == REQUEST_ENCODE_WITH_TREE) // If we are encoding with a tree file,
+	{
+		if (payloadSize < 2) // the payload starts with the length of the tree file name,
+		{
+			response = "Missing tree file name.";
+
+			return STATUS_ERROR;
+		}
+
+		size_t nameLength = (unsigned char)payload[0] | (unsigned char)payload[1] << 8;
+
+		if (payloadSize < 2 + nameLength) // followed by the name itself.
+		{
+			response = "Missing tree file name.";
+
+			return STATUS_ERROR;
+		}
+
+		string treeBuilder; // The bytes of the tree file
+
+		if (!loadTreeFile(string(payload + 2, nameLength), treeBuilder)) // If we can't read the tree file,
+		{
+			response = "Unable to open tree file."; // we can't encode with it.
+
+			return STATUS_ERROR;
+		}
+
+		// Everything after the name is what we encode, using an instance that already has the tree built if we have one.
+		// If we encode in blocks, the tree file is only the shared tree, and blocks that code better with their own tree
+		// switch to it, so that goes to the scratch instance instead, for the same reason block payloads are decoded there.
+		Huffman* huffman = settings != nullptr && settings->GetBlockSize() != 0 ? &scratch : findWarmTree(treeBuilder, warmTrees);
+
+		return finishRequest(*huffman, huffman->EncodeBufferWithTree(payload + 2 + nameLength, payloadSize - 2 - nameLength, treeBuilder, response), response);
+	}
+
+	response = "Unknown request."; // Otherwise, we don't know what the client wants.
+
+	return STATUS_ERROR;
+}
+
+unsigned char HuffmanDaemon::finishRequest(Huffman& huffman, bool succeeded, string& response)
+{
+	// This method works out the status of a request once the given instance has handled it.
+	// If it failed, whatever was written to the response so far is only part of the output,
+	// so we replace it with the reason the instance kept for us.
+	//
+	if (succeeded)
+	{
+		return STATUS_OK;
+	}
+
+	response = huffman.GetError();
+
+	return STATUS_ERROR;
+}
+
+Huffman* HuffmanDaemon::findWarmTree(const string& treeBuilder, warmtrees& warmTrees)
+{
+	// This method returns the worker's instance for the given tree builder bytes. If the worker
+	// hasn't seen the tree yet, we make a new instance for it, which will build the tree the first
+	// time it's used and keep it from then on. If we already have as many instances as we want to
+	// keep, the one used longest ago makes room for it, so trees in steady use are never thrown out.
+	//
+	unique_ptr<Huffman>* found = warmTrees.find(treeBuilder);
+
+	if (found != nullptr) // If we already have an instance for this tree,
+	{
+		return found->get(); // we use it.
+	}
+
+	Huffman* huffman = new Huffman(); // Otherwise, we make a new instance for the tree,
+
+	applySettings(*huffman);
+
+	warmTrees.insert(treeBuilder).reset(huffman); // and keep it around for the next request that uses it.
+
+	return huffman;
+}
+
+void HuffmanDaemon::applySettings(Huffman& huffman)
+{
+	// This method gives a new instance the settings we were given, if we were given any.
+	//
+	if (settings != nullptr)
+	{
+		huffman.CopySettings(*settings);
+	}
+}
+
+bool HuffmanDaemon::loadTreeFile(const string& name, string& treeBuilder)
+{
+	// This method gets the tree builder bytes of the tree file with the given name. The name comes
+	// from a client, so it has to be a plain file name: anything that could lead out of the tree
+	// directory, like a slash or a name starting with a dot, is refused. We keep the bytes of the
+	// tree files used most recently around for every worker to use, so they aren't read every time.
+	// Tree files are expected to stay the same while the daemon is running.
+	//
+	if (treeDirectory.empty() || name.empty() || name[0] == '.' || name.find_first_of(string("/\\\0", 3)) != string::npos)
+	{
+		return false;
+	}
+
+	lock_guard<mutex> lock(treeFilesMutex);
+
+	string* found = treeFiles.find(name);
+
+	if (found != nullptr) // If we've read the tree file recently,
+	{
+		treeBuilder = *found; // we just use the bytes we read.
+
+		return true;
+	}
+
+	ifstream treeStream(treeDirectory + "/" + name, ios::binary); // Otherwise, we open it,
+
+	treeBuilder.assign(HuffmanFormat::TREE_BUILDER_SIZE, '\0');
+
+	if (!treeStream.read(&treeBuilder[0], HuffmanFormat::TREE_BUILDER_SIZE)) // and read its bytes. If we can't,
+	{
+		return false; // we can't use it.
+	}
+
+	treeFiles.insert(name) = treeBuilder; // We remember the bytes for next time.
+
+	return true;
+}
+
+bool HuffmanDaemon::readFully(int socket, char* buffer, size_t size)
+{
+	// This method reads exactly the given amount of bytes from the socket. A single read can
+	// return fewer bytes than we asked for, so we keep reading until we have all of them.
+	//
+	while (size > 0)
+	{
+		ssize_t received = recv(socket, buffer, size, 0);
+
+		if (received < 0 && errno == EINTR) // If we were interrupted before reading anything,
+		{
+			continue; // we just try again.
+		}
+
+		if (received <= 0) // If the socket closed or failed,
+		{
+			return false; // we can't read the rest.
+		}
+
+		buffer += received; // Otherwise, we move past what we read,
+
+		size -= received; // and have that much less left to read.
+	}
+
+	return true;
+}
+
+bool HuffmanDaemon::sendResponse(int socket, unsigned char status, const string& payload)
+{
+	// This method sends a response frame. The length and status go in a small header, and
+	// we hand the header and the payload to the kernel together with writev, so the payload
+	// is sent straight from the string it was encoded or decoded into.
+	//
+	if (payload.size() > MAX_OUTPUT_LIMIT) // If the frame length can't describe the payload, the client would get a corrupt frame,
+	{
+		return false; // so we don't send anything at all.
+	}
+
+	unsigned int length = (unsigned int)payload.size() + 1; // The frame is the status followed by the payload.
+
+	unsigned char frameHeader[5] = { (unsigned char)length, (unsigned char)(length >> 8), (unsigned char)(length >> 16), (unsigned char)(length >> 24), status };
+
+	iovec pieces[2]; // The two pieces of the frame: the header and the payload
+
+	pieces[0].iov_base = frameHeader;
+	pieces[0].iov_len = sizeof(frameHeader);
+
+	pieces[1].iov_base = const_cast<char*>(payload.data());
+	pieces[1].iov_len = payload.size();
+
+	int current = 0; // The piece we are currently sending
+
+	while (current < 2)
+	{
+		ssize_t sent = writev(socket, pieces + current, 2 - current);
+
+		if (sent < 0 && errno == EINTR) // If we were interrupted before sending anything,
+		{
+			continue; // we just try again.
+		}
+
+		if (sent < 0) // If the socket failed,
+		{
+			return false; // we can't send the rest.
+		}
+
+		// A single write can send less than we asked it to, so we skip past every piece that was
+		// sent completely, and move the start of the piece that was only partly sent.
+		while (current < 2 && (size_t)sent >= pieces[current].iov_len)
+		{
+			sent -= pieces[current].iov_len;
+
+			current++;
+		}
+
+		if (current < 2)
+		{
+			pieces[current].iov_base = (char*)pieces[current].iov_base + sent;
+			pieces[current].iov_len -= sent;
+		}
+	}
+
+	return true;
+}
+#endif
@@ -0,0 +1,132 @@
+//==============================================================================================
+// File: HuffmanDaemon.h - Huffman daemon
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Huffman.h"
+
+using namespace std;
+
+class HuffmanDaemon {
+public:
+	HuffmanDaemon(string socketPath, unsigned int workerCount);
+
+	bool Run(); // Services requests on the socket until the process is interrupted, returning false if the socket can't be set up
+	void Stop(); // Makes Run stop as if the process was interrupted, from any thread
+	void SetMaxOutputSize(unsigned long long size); // Sets the largest response payload we send, so a small request can't make us build a huge one
+	void SetTreeDirectory(string directory); // Sets the directory the tree files clients ask for are read from, or an empty string to refuse them
+	void SetSettings(const Huffman* settings); // Sets the instance whose settings every instance of the workers copies, which has to stay around while we run, or nullptr for the defaults
+
+	// The first byte of every request says what to do with the rest of it.
+	const static unsigned char REQUEST_ENCODE = 'e';			// Encode the payload, building the tree from it
+	const static unsigned char REQUEST_DECODE = 'd';			// Decode the payload
+	const static unsigned char REQUEST_ENCODE_WITH_TREE = 't';	// Encode the payload with a tree file in the tree directory: a 2 byte name length and the name come before the payload
+
+	// The first byte of every response says whether the request succeeded. On failure, the rest is an error message.
+	const static unsigned char STATUS_OK = 0;
+	const static unsigned char STATUS_ERROR = 1;
+
+	const static unsigned int MAX_FRAME_SIZE = 1u << 30;	// The largest request we accept, so a bad length can't make us allocate everything
+	const static unsigned long long DEFAULT_MAX_OUTPUT_SIZE = MAX_FRAME_SIZE - 1;	// The largest response payload we send unless told otherwise, so responses fit the same frames as requests
+	const static unsigned long long MAX_OUTPUT_LIMIT = UINT_MAX - 1;	// The largest response payload a frame length can describe, along with the status byte
+	const static unsigned int WARM_TREES_PER_WORKER = 16;	// The amount of built trees each worker keeps around for requests that use them again
+	const static unsigned int MAX_TREE_FILES = 64;			// The amount of tree files whose bytes we keep around, so they don't have to be read again
+	const static int CLIENT_TIMEOUT_SECONDS = 30;			// How long a worker waits on a client that stops sending or receiving partway through a frame
+private:
+	// A map that keeps at most a given amount of entries. When it's full, the entry that was used
+	// longest ago is thrown out to make room for a new one, so the entries in use stay around.
+	template <typename T>
+	class lrucache {
+	public:
+		lrucache(size_t capacity) : capacity(capacity) {}
+
+		T* find(const string& key) // Returns the value for the given key, marking it as just used, or nullptr if there is none
+		{
+			typename map<string, entry>::iterator found = entries.find(key);
+
+			if (found == entries.end())
+			{
+				return nullptr;
+			}
+
+			order.splice(order.begin(), order, found->second.position); // It's the most recently used entry now.
+
+			return &found->second.value;
+		}
+
+		T& insert(const string& key) // Adds an entry for the given key, which must not have one yet, and returns its value
+		{
+			if (entries.size() >= capacity) // If we're full, the least recently used entry goes.
+			{
+				entries.erase(order.back());
+
+				order.pop_back();
+			}
+
+			order.push_front(key);
+
+			entry& added = entries[key];
+
+			added.position = order.begin();
+
+			return added.value;
+		}
+	private:
+		struct entry {
+			T value;								// The value of the entry
+			typename list<string>::iterator position;	// Where the entry's key is in the order
+		};
+
+		size_t capacity;				// The most entries we keep
+		list<string> order;				// The keys, from the most recently used to the least
+		map<string, entry> entries;		// The entries, by key
+	};
+
+	typedef lrucache<unique_ptr<Huffman>> warmtrees; // Huffman instances with their trees built, keyed by tree builder bytes
+
+	string socketPath;			// The path of the Unix domain socket we listen on
+	unsigned int workerCount;	// The amount of worker threads servicing clients
+	unsigned long long maxOutputSize; // The largest response payload we send
+	const Huffman* settings;	// The instance whose settings the workers' instances copy, or nullptr if they keep the defaults
+
+	int wakePipe[2];			// A pipe the listener waits on along with the clients, written to when a client is handed back or we are asked to stop
+
+	mutex clientsMutex;						// Guards everything about clients below
+	condition_variable clientsAvailable;	// Wakes workers up when a client has a request waiting or we are stopping
+	queue<int> readyClients;				// Clients that have sent something, waiting for a worker to service their next request
+	set<int> activeClients;					// Clients a worker is servicing, so they can be shut down when we stop
+	vector<int> returnedClients;			// Clients a worker is done with, waiting for the listener to watch them again
+	bool stopping;							// Whether we are stopping, so workers should stop taking clients
+
+	string treeDirectory;			// The directory tree files are read from, or an empty string if clients can't use them
+	mutex treeFilesMutex;			// Guards the tree files below
+	lrucache<string> treeFiles;		// The tree builder bytes of the tree files we've read most recently, keyed by name
+
+	void workerLoop(); // Takes clients off of the queue and services one request from each until we are stopping
+	bool serveRequest(int client, string& request, string& response, warmtrees& warmTrees, Huffman& scratch); // Services one request from the given client, returning false if it disconnected or can't be serviced anymore
+	void wakeListener(); // Wakes the listener up so it looks at the returned clients
+	unsigned char handleRequest(const string& request, string& response, warmtrees& warmTrees, Huffman& scratch); // Handles one request, putting the response payload into response and returning its status
+	unsigned char runRequest(const string& request, string& response, warmtrees& warmTrees, Huffman& scratch); // Does what the request asks for, putting the response payload into response and returning its status
+	Huffman* findWarmTree(const string& treeBuilder, warmtrees& warmTrees); // Returns the instance for the given tree builder bytes, making room for it if it's new
+	void applySettings(Huffman& huffman); // Gives the given new instance the settings the workers' instances copy
+	static unsigned char finishRequest(Huffman& huffman, bool succeeded, string& response); // Returns the status of a request the given instance handled, replacing the response with why it failed if it did
+	bool loadTreeFile(const string& name, string& treeBuilder); // Gets the tree builder bytes of the tree file with the given name in the tree directory, reading it only if it isn't kept around
+	static bool readFully(int socket, char* buffer, size_t size); // Reads exactly size bytes from the socket, returning false if it closes first
+	static bool sendResponse(int socket, unsigned char status, const string& payload); // Sends a response frame with the given status and payload
+};
@@ -0,0 +1,191 @@
+//==============================================================================================
+// File: HuffmanFormat.cpp - Huffman file format implementation
+// c.f.: HuffmanFormat.h
+//
+// This class reads and writes the pieces of a .huf file that surround the tree builder and the
+// encoded bits: the header at the very start of the file, and the numbers used by the optional
+// sections that follow the encoded bits.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <cstring>
+
+#include "HuffmanFormat.h"
+
+const unsigned char HuffmanFormat::MAGIC[4] = { 0xFF, 'H', 'U', 'F' };
+
+int HuffmanFormat::headerSize(const header& fileHeader)
+{
+	// This method returns the size of the given header. Since version 3, the length
+	// of the original file comes right after the flags, and since version 4, it can be
+	// followed by the checksum, if the flags say so. Older versions never turn that flag on.
+	//
+	int size = HEADER_SIZE;
+
+	if (fileHeader.version >= 3)
+	{
+		size += LENGTH_SIZE;
+	}
+
+	if (fileHeader.flags & FLAG_CHECKSUM)
+	{
+		size += CHECKSUM_SIZE;
+	}
+
+	return size;
+}
+
+int HuffmanFormat::writeHeader(ostream& stream, const header& fileHeader)
+{
+	// This method writes the magic bytes, the version, the flags and, for versions that
+	// have them, the original length and checksum of the given header to the stream. It
+	// returns the amount of bytes written so that callers can add it to their bytes out counter.
+	//
+	stream.write((const char*)MAGIC, sizeof(MAGIC)); // Write the magic bytes so decoders know this file has a header,
+
+	stream.put(fileHeader.version); // followed by the version
+	stream.put(fileHeader.flags); // and the flags.
+
+	if (fileHeader.version >= 3) // Since version 3,
+	{
+		writeNumber(stream, fileHeader.originalLength, LENGTH_SIZE); // the original length comes next.
+	}
+
+	if (fileHeader.flags & FLAG_CHECKSUM) // If the file has a checksum,
+	{
+		writeNumber(stream, fileHeader.checksum, CHECKSUM_SIZE); // it comes last.
+	}
+
+	return headerSize(fileHeader);
+}
+
+bool HuffmanFormat::readHeader(istream& stream, header& fileHeader)
+{
+	// This method reads a header from the stream. If the stream doesn't start with
+	// the magic bytes, the file was written before the header existed, so we put
+	// the stream back where it was and return false so the caller can treat the
+	// rest of the file as a tree builder followed by encoded bits.
+	//
+	streampos start = stream.tellg(); // Remember where we started so we can go back if there is no header.
+
+	unsigned char magic[sizeof(MAGIC)] = { 0 };
+
+	stream.read((char*)magic, sizeof(magic)); // Read as many bytes as the magic takes up.
+
+	if (!stream || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) // If we couldn't read them or they don't match,
+	{
+		stream.clear();		// we clear any error caused by a short file,
+		stream.seekg(start);	// go back to where we started,
+
+		return false;		// and say there was no header.
+	}
+
+	fileHeader.version = stream.get(); // Otherwise, we read the version
+	fileHeader.flags = stream.get(); // and the flags.
+
+	if (fileHeader.version >= 3) // Since version 3,
+	{
+		fileHeader.originalLength = readNumber(stream, LENGTH_SIZE); // the original length comes next.
+	}
+
+	if (fileHeader.flags & FLAG_CHECKSUM) // If the file has a checksum,
+	{
+		fileHeader.checksum = (unsigned int)readNumber(stream, CHECKSUM_SIZE); // it comes last.
+	}
+
+	return true;
+}
+
+bool HuffmanFormat::readHeader(const char* data, size_t size, header& fileHeader)
+{
+	// This method reads a header from the given bytes of a file, for callers that already
+	// have the file in memory and need to know what comes after the header. If the bytes
+	// don't start with a header, we return false and leave the given header alone.
+	//
+	if (size < HEADER_SIZE || memcmp(data, MAGIC, sizeof(MAGIC)) != 0) // If there is no room for a header, or no magic,
+	{
+		return false; // the file doesn't have a header.
+	}
+
+	header read;
+
+	read.version = data[sizeof(MAGIC)]; // Otherwise, the version comes right after the magic,
+	read.flags = data[sizeof(MAGIC) + 1]; // and the flags come after the version.
+
+	if (size < (size_t)headerSize(read)) // If there is no room for the rest of a header with that version and flags,
+	{
+		return false; // the bytes are too short to be a file with a header.
+	}
+
+	if (read.version >= 3) // Since version 3,
+	{
+		read.originalLength = 0;
+
+		for (int i = 0; i < LENGTH_SIZE; i++) // the original length comes next, least significant byte first.
+		{
+			read.originalLength |= (unsigned long long)(unsigned char)data[HEADER_SIZE + i] << (8 * i);
+		}
+	}
+
+	if (read.flags & FLAG_CHECKSUM) // If the file has a checksum,
+	{
+		for (int i = 0; i < CHECKSUM_SIZE; i++) // it comes last, the same way.
+		{
+			read.checksum |= (unsigned int)(unsigned char)data[CHECKSUM_POSITION + i] << (8 * i);
+		}
+	}
+
+	fileHeader = read;
+
+	return true;
+}
+
+void HuffmanFormat::writeNumber(ostream& stream, unsigned long long number, int byteCount)
+{
+	// This method writes the given number to the stream one byte at a time, starting with
+	// the least significant byte, so the file reads the same on every machine.
+	//
+	for (int i = 0; i < byteCount; i++)
+	{
+		stream.put((unsigned char)(number >> (8 * i))); // Shift the byte we want into the bottom 8 bits and write it.
+	}
+}
+
+unsigned long long HuffmanFormat::readNumber(istream& stream, int byteCount)
+{
+	// This method reads a number written by writeNumber, putting each byte
+	// back into the position it was shifted out of.
+	//
+	unsigned long long number = 0;
+
+	for (int i = 0; i < byteCount; i++)
+	{
+		unsigned char byte = stream.get(); // Read the next byte,
+
+		number |= (unsigned long long)byte << (8 * i); // and put it into its place in the number.
+	}
+
+	return number;
+}
+
+bool HuffmanFormat::seekTableSize(unsigned long long entryCount, unsigned long long available, unsigned long long& tableSize)
+{
+	// This method works out how many bytes a seek table with the given amount of entries
+	// takes up, including its footer, and makes sure that fits in the given amount of bytes,
+	// which is everything after the start of the encoded bits. The count comes from the file,
+	// so we divide the room left for the entries instead of multiplying the count, since a
+	// huge count would overflow and look small. If the table doesn't fit, the file is corrupt.
+	//
+	if (available < (unsigned long long)SEEK_FOOTER_SIZE || entryCount > (available - SEEK_FOOTER_SIZE) / SEEK_ENTRY_SIZE)
+	{
+		return false;
+	}
+
+	tableSize = SEEK_FOOTER_SIZE + entryCount * SEEK_ENTRY_SIZE; // Otherwise, this can't overflow, since it is no more than the available bytes.
+
+	return true;
+}
@@ -0,0 +1,63 @@
+//==============================================================================================
+// File: HuffmanFormat.h - Huffman file format
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <climits>
+#include <iostream>
+
+using namespace std;
+
+class HuffmanFormat {
+public:
+	struct header {
+		unsigned char version = 0;	// The version of the format the file was written with
+		unsigned char flags = 0;	// A combination of the FLAG_ constants describing what optional sections the file has
+		unsigned long long originalLength = ULLONG_MAX; // The length of the original file, or UNKNOWN_LENGTH if the file doesn't say (before version 3)
+		unsigned int checksum = 0;	// The CRC32C of the original file, if the FLAG_CHECKSUM flag is on
+	};
+
+	// The bytes every framed .huf file starts with. A tree builder always lists the smaller index of a pair
+	// first, so a file written before the header existed can never start with 0xFF - this is how we tell the
+	// two apart.
+	static const unsigned char MAGIC[4];
+
+	const static unsigned char VERSION = 5;			// The version of the format written by this program
+	const static unsigned char FLAG_SEEK_TABLE = 1;	// The file ends with a seek table followed by a seek table footer
+	const static unsigned char FLAG_STORED = 2;		// The original bytes follow the header as is, with no tree builder (since version 2)
+	const static unsigned char FLAG_CHECKSUM = 4;	// The header ends with the CRC32C of the original file (since version 4)
+	const static unsigned char FLAG_BLOCKS = 8;		// The input is split into blocks, each coded with the tree that suits it best (since version 5)
+
+	// How each block of a file with the FLAG_BLOCKS flag is stored, which is the first byte of the block.
+	const static unsigned char BLOCK_STORED = 0;		// The original bytes of the block, as is
+	const static unsigned char BLOCK_SHARED_TREE = 1;	// Encoded with the shared tree that comes before the first block
+	const static unsigned char BLOCK_NEW_TREE = 2;		// Encoded with a tree whose tree builder comes right before the encoded bits
+	const static unsigned char BLOCK_PREVIOUS_TREE = 3;	// Encoded with the tree of the last block that brought its own
+
+	const static unsigned long long UNKNOWN_LENGTH = ULLONG_MAX; // The original length of files written before the header had one
+
+	const static int TREE_BUILDER_SIZE = 510;	// The amount of bytes a tree builder takes up: one pair of indices for each of the 255 combinations
+	const static int HEADER_SIZE = 6;			// The amount of bytes every header takes up: the magic, version and flags
+	const static int LENGTH_SIZE = 8;			// The amount of bytes the original length after the flags takes up (since version 3)
+	const static int CHECKSUM_SIZE = 4;			// The amount of bytes the checksum after the original length takes up
+	const static int CHECKSUM_POSITION = 14;	// The position of the checksum in the file, right after the original length
+	const static int SEEK_ENTRY_SIZE = 16;		// The amount of bytes a seek table entry takes up: a symbol position and a bit offset
+	const static int SEEK_FOOTER_SIZE = 12;		// The amount of bytes the seek table footer takes up: the interval and the entry count
+	const static int BLOCK_SIZE_LENGTH = 4;		// The amount of bytes the block size before the shared tree builder takes up
+	const static int BLOCK_HEADER_SIZE = 5;		// The amount of bytes before each block: how it is stored and how many bytes of data it has
+	const static unsigned int MAX_BLOCK_SIZE = 1 << 30; // The largest amount of symbols a block can have, so every block fits its header
+
+	static int headerSize(const header& fileHeader); // Returns the amount of bytes the given header takes up, which depends on its version and flags
+	static int writeHeader(ostream& stream, const header& fileHeader); // Writes the given header to the stream, returning the amount of bytes written
+	static bool readHeader(istream& stream, header& fileHeader); // Reads a header from the stream, returning false and rewinding the stream if the file has none
+	static bool readHeader(const char* data, size_t size, header& fileHeader); // Reads a header from the given bytes of a file, returning false if they don't start with one
+	static void writeNumber(ostream& stream, unsigned long long number, int byteCount); // Writes the lowest byteCount bytes of the number, least significant first
+	static unsigned long long readNumber(istream& stream, int byteCount); // Reads a number of byteCount bytes, least significant first
+	static bool seekTableSize(unsigned long long entryCount, unsigned long long available, unsigned long long& tableSize); // Gets the size of a seek table with the given amount of entries and its footer, returning false if it is larger than the available bytes
+};
@@ -0,0 +1,623 @@
+//==============================================================================================
+// File: HuffmanStreamDecoder.cpp - Huffman streaming decoder implementation
+// c.f.: HuffmanStreamDecoder.h
+//
+// This class decodes the same files as Huffman::DecodeFile, but instead of pulling bytes out
+// of a stream until it ends, it works on whatever bytes have been fed to it so far. All of the
+// work happens in Drain: it moves through the header, the tree builder and the encoded bits as
+// far as the bytes it has allow, then stops and remembers exactly where it was. The node of the
+// tree we are at and the bits of the byte we haven't looked at yet are kept as members instead
+// of locals, so a code split across two pieces of input is finished on the next call. Files
+// split into blocks go back to reading a block header after the last symbol of each block, and
+// switch to whichever tree it says the next block uses. Files with a checksum have every byte
+// we drain added to a checksum of our own, and only count as done if the two match.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <cstring>
+
+#include "HuffmanStreamDecoder.h"
+
+HuffmanStreamDecoder::HuffmanStreamDecoder()
+{
+	// The constructor. Everything about the file we are decoding
+	// is set up by Reset, so a decoder starts out ready for one.
+	//
+	checkingChecksum = true;
+
+	Reset();
+}
+
+void HuffmanStreamDecoder::Feed(const char* data, size_t size)
+{
+	// This method adds the given bytes to the ones waiting to be decoded. Nothing is decoded
+	// here, so feeding never takes longer than copying the bytes. When most of the pending
+	// bytes have been used, we get rid of them first, so the pending bytes never grow much
+	// past what hasn't been decoded yet.
+	//
+	if (pendingStart > 0 && pendingStart >= pending.size() / 2) // If at least half of the pending bytes have been used,
+	{
+		pending.erase(0, pendingStart); // we drop them,
+
+		pendingStart = 0; // so the next byte to use is at the beginning again.
+	}
+
+	pending.append(data, size);
+}
+
+void HuffmanStreamDecoder::Finish()
+{
+	// This method says no more bytes are coming. Until then, running out of bytes just means
+	// waiting for more, but after it, running out before the end of the file means the file
+	// was cut off. Files without the original length also need it to know where they end.
+	//
+	finished = true;
+}
+
+size_t HuffmanStreamDecoder::Drain(char* output, size_t capacity)
+{
+	// This method decodes as much as it can into the given output, without writing more than
+	// capacity bytes. We keep moving through the file as long as each step gets somewhere, and
+	// stop as soon as the output is full, we need bytes that haven't arrived yet, or we are done.
+	// Everything we decode is added to our checksum on the way out, so once we reach the end of a
+	// file that has one, we can tell whether the output is what was encoded before saying we're done.
+	//
+	size_t written = 0; // The amount of bytes we've decoded into the output so far
+
+	bool moving = true; // Whether the last step got anywhere
+
+	while (moving && written < capacity)
+	{
+		if (state == READING_HEADER)
+		{
+			moving = readHeader();
+		}
+		else if (state == READING_TREE_BUILDER)
+		{
+			moving = readTreeBuilder();
+		}
+		else if (state == READING_BLOCK_HEADER)
+		{
+			moving = readBlockHeader();
+		}
+		else if (state == DECODING)
+		{
+			moving = decode(output, capacity, written);
+		}
+		else if (state == COPYING)
+		{
+			moving = copy(output, capacity, written);
+		}
+		else // Otherwise, we are done or have failed, so there is nothing left to do.
+		{
+			moving = false;
+		}
+	}
+
+	if (checkingChecksum && (fileHeader.flags & HuffmanFormat::FLAG_CHECKSUM)) // If we check the file's checksum,
+	{
+		checksum.Update(output, written); // we add what we decoded to ours.
+
+		if (state == DONE && checksum.GetValue() != fileHeader.checksum) // If that was the end of the file, and the two don't match,
+		{
+			fail("The input is corrupt."); // something changed the input after it was encoded.
+		}
+	}
+
+	return written;
+}
+
+void HuffmanStreamDecoder::Reset()
+{
+	// This method gets the decoder ready for another file, forgetting everything about the
+	// last one except its tree, which our Huffman instance keeps in case it comes up again.
+	//
+	state = READING_HEADER;
+	pending.clear();
+	pendingStart = 0;
+	finished = false;
+	checksum = Crc32c();
+	error.clear();
+	fileHeader = HuffmanFormat::header();
+	holdingTrailer = false;
+	tables = nullptr;
+	symbolsLeft = HuffmanFormat::UNKNOWN_LENGTH;
+	currentNode = 0;
+	currentByte = 0;
+	bitsLeft = 0;
+	blockSize = 0;
+	sharedTreeBuilder.clear();
+	previousTreeBuilder.clear();
+	blockSymbolsLeft = 0;
+	blockBytesLeft = 0;
+}
+
+void HuffmanStreamDecoder::SetTableCache(string directory)
+{
+	// This method sets the directory of the table cache our Huffman instance
+	// uses to build trees. It can only be changed between files, since the
+	// tables of the current file may be mapped from the old cache.
+	//
+	huffman.SetTableCache(directory);
+
+	tables = nullptr;
+}
+
+void HuffmanStreamDecoder::SetChecksumCheck(bool enabled)
+{
+	// This method sets whether we check the output of files that have a checksum against it.
+	// It's only worth turning off when the checksum in the header can't be trusted yet, like
+	// when the file is still being written and the checksum is filled in at the end.
+	//
+	checkingChecksum = enabled;
+}
+
+bool HuffmanStreamDecoder::IsDone() const
+{
+	return state == DONE;
+}
+
+bool HuffmanStreamDecoder::HasFailed() const
+{
+	return state == FAILED;
+}
+
+const string& HuffmanStreamDecoder::GetError() const
+{
+	return error;
+}
+
+size_t HuffmanStreamDecoder::available() const
+{
+	return pending.size() - pendingStart;
+}
+
+bool HuffmanStreamDecoder::readHeader()
+{
+	// This method reads the header once enough of it has arrived. We need the magic bytes to
+	// know if there is a header at all, then the version and flags to know how long it is. Files
+	// without a header start right with the tree builder, so we just move on to reading it.
+	//
+	const char* data = pending.data() + pendingStart;
+
+	if (available() < sizeof(HuffmanFormat::MAGIC) && !finished) // If we don't have enough bytes to tell if there is a header,
+	{
+		return false; // we wait for more.
+	}
+
+	if (available() < sizeof(HuffmanFormat::MAGIC) || memcmp(data, HuffmanFormat::MAGIC, sizeof(HuffmanFormat::MAGIC)) != 0) // If there isn't one,
+	{
+		state = READING_TREE_BUILDER; // the file was written before headers existed, so the tree builder comes first.
+
+		return true;
+	}
+
+	if (!HuffmanFormat::readHeader(data, available(), fileHeader)) // If there is a header, but not all of it has arrived,
+	{
+		if (finished) // and nothing else is coming,
+		{
+			fail("The input is truncated."); // the file was cut off.
+		}
+
+		return false; // Otherwise, we wait for more.
+	}
+
+	if (fileHeader.version == 0 || fileHeader.version > HuffmanFormat::VERSION) // If the file was written with a version we don't know,
+	{
+		fail("Unsupported file version."); // we can't decode it.
+
+		return false;
+	}
+
+	pendingStart += HuffmanFormat::headerSize(fileHeader); // We've used the header,
+
+	symbolsLeft = fileHeader.originalLength; // and it tells us how many symbols there are, if it knows.
+
+	// Files split into blocks always have the original length, since that's how we know how long the last block is.
+	if ((fileHeader.flags & HuffmanFormat::FLAG_BLOCKS) && fileHeader.originalLength == HuffmanFormat::UNKNOWN_LENGTH)
+	{
+		fail("The input has an invalid block.");
+
+		return false;
+	}
+
+	// Without the original length, the only way to find where the encoded bits stop and the seek table
+	// starts is to read the footer at the very end of the file, so we have to hold onto everything until then.
+	holdingTrailer = (fileHeader.flags & HuffmanFormat::FLAG_SEEK_TABLE) && fileHeader.originalLength == HuffmanFormat::UNKNOWN_LENGTH;
+
+	state = (fileHeader.flags & HuffmanFormat::FLAG_STORED) ? COPYING : READING_TREE_BUILDER; // Stored files have no tree builder.
+
+	return true;
+}
+
+bool HuffmanStreamDecoder::readTreeBuilder()
+{
+	// This method reads the tree builder once all 510 bytes of it have arrived, and gets the
+	// tables of its tree from our Huffman instance, which only builds the tree if it doesn't
+	// already have it, either built or in its table cache. In files split into blocks, the
+	// block size comes first, and we only keep the tree builder, since the shared tree it
+	// describes is only built once a block uses it.
+	//
+	if (fileHeader.flags & HuffmanFormat::FLAG_BLOCKS) // If the file is split into blocks,
+	{
+		if (available() < (size_t)(HuffmanFormat::BLOCK_SIZE_LENGTH + HuffmanFormat::TREE_BUILDER_SIZE)) // and we don't have the block size and whole tree builder yet,
+		{
+			if (finished) // and nothing else is coming,
+			{
+				fail("The input is truncated."); // the file was cut off.
+			}
+
+			return false; // Otherwise, we wait for more.
+		}
+
+		const unsigned char* data = (const unsigned char*)pending.data() + pendingStart;
+
+		blockSize = 0;
+
+		for (int i = 0; i < HuffmanFormat::BLOCK_SIZE_LENGTH; i++) // The block size is least significant byte first.
+		{
+			blockSize |= (unsigned int)data[i] << (8 * i);
+		}
+
+		if (blockSize == 0 || blockSize > HuffmanFormat::MAX_BLOCK_SIZE) // If the size is one we never write,
+		{
+			fail("The input has an invalid block."); // the file is corrupt.
+
+			return false;
+		}
+
+		sharedTreeBuilder = pending.substr(pendingStart + HuffmanFormat::BLOCK_SIZE_LENGTH, HuffmanFormat::TREE_BUILDER_SIZE);
+
+		pendingStart += HuffmanFormat::BLOCK_SIZE_LENGTH + HuffmanFormat::TREE_BUILDER_SIZE; // We've used both,
+
+		state = READING_BLOCK_HEADER; // so the first block comes next.
+
+		return true;
+	}
+
+	if (available() < (size_t)HuffmanFormat::TREE_BUILDER_SIZE) // If we don't have the whole tree builder yet,
+	{
+		if (finished) // and nothing else is coming,
+		{
+			fail("The input is truncated."); // the file was cut off.
+		}
+
+		return false; // Otherwise, we wait for more.
+	}
+
+	tables = huffman.GetTables(pending.substr(pendingStart, HuffmanFormat::TREE_BUILDER_SIZE));
+
+	if (tables == nullptr) // If the bytes don't describe a tree,
+	{
+		fail("The input has an invalid tree builder."); // we can't decode the file.
+
+		return false;
+	}
+
+	pendingStart += HuffmanFormat::TREE_BUILDER_SIZE; // We've used the tree builder,
+
+	state = DECODING; // so the encoded bits come next.
+
+	return true;
+}
+
+bool HuffmanStreamDecoder::readBlockHeader()
+{
+	// This method moves on to the next block of a file split into blocks. The last symbol of
+	// a block may end before the last byte of its data, so we first skip whatever is left of
+	// it. Then, once the header of the next block has arrived, along with its tree builder if
+	// it brings its own tree, we get ready to copy or decode it. It returns whether anything
+	// happened.
+	//
+	size_t skipped = available() < blockBytesLeft ? available() : (size_t)blockBytesLeft; // We skip what we can of the last block,
+
+	pendingStart += skipped;
+
+	blockBytesLeft -= skipped;
+
+	if (blockBytesLeft > 0) // and if there's more of it than we have,
+	{
+		if (finished) // and nothing else is coming,
+		{
+			fail("The input is truncated."); // the file was cut off.
+		}
+
+		return skipped > 0; // Otherwise, we wait for more.
+	}
+
+	if (symbolsLeft == 0) // If every symbol has been decoded, we're done.
+	{
+		state = DONE;
+
+		return true;
+	}
+
+	const unsigned char* data = (const unsigned char*)pending.data() + pendingStart;
+
+	unsigned char mode = available() > 0 ? data[0] : 0; // How the block is stored, which tells us how long its header is
+
+	size_t headerLength = HuffmanFormat::BLOCK_HEADER_SIZE + (mode == HuffmanFormat::BLOCK_NEW_TREE ? HuffmanFormat::TREE_BUILDER_SIZE : 0);
+
+	if (available() < headerLength) // If we don't have the whole header yet,
+	{
+		if (finished) // and nothing else is coming,
+		{
+			fail("The input is truncated."); // the file was cut off.
+		}
+
+		return skipped > 0; // Otherwise, we wait for more.
+	}
+
+	unsigned long long dataLength = 0; // The amount of bytes of data the block has, least significant byte first
+
+	for (int i = 0; i < HuffmanFormat::BLOCK_HEADER_SIZE - 1; i++)
+	{
+		dataLength |= (unsigned long long)data[1 + i] << (8 * i);
+	}
+
+	unsigned long long count = symbolsLeft < blockSize ? symbolsLeft : blockSize; // Every block but the last has the block size worth of symbols.
+
+	if (mode == HuffmanFormat::BLOCK_NEW_TREE) // If the block brings its own tree, it becomes the previous tree from now on.
+	{
+		previousTreeBuilder = pending.substr(pendingStart + HuffmanFormat::BLOCK_HEADER_SIZE, HuffmanFormat::TREE_BUILDER_SIZE);
+	}
+
+	// A block can't be stored some way we don't know, use the previous tree if there isn't one, or be stored as is without a byte for each symbol.
+	if (mode > HuffmanFormat::BLOCK_PREVIOUS_TREE || (mode == HuffmanFormat::BLOCK_PREVIOUS_TREE && previousTreeBuilder.empty())
+		|| (mode == HuffmanFormat::BLOCK_STORED && dataLength != count))
+	{
+		fail("The input has an invalid block.");
+
+		return false;
+	}
+
+	if (mode == HuffmanFormat::BLOCK_STORED) // If the block is stored as is, we copy its bytes.
+	{
+		state = COPYING;
+	}
+	else // Otherwise, we get the tables of its tree and decode it.
+	{
+		tables = huffman.GetTables(mode == HuffmanFormat::BLOCK_SHARED_TREE ? sharedTreeBuilder : previousTreeBuilder);
+
+		if (tables == nullptr) // If the bytes don't describe a tree,
+		{
+			fail("The input has an invalid tree builder."); // we can't decode the file.
+
+			return false;
+		}
+
+		state = DECODING;
+	}
+
+	pendingStart += headerLength; // We've used the header,
+
+	blockSymbolsLeft = count; // and the block has this many symbols
+	blockBytesLeft = dataLength; // in this many bytes.
+
+	return true;
+}
+
+bool HuffmanStreamDecoder::dropTrailer()
+{
+	// This method removes the seek table from the end of the pending bytes. The footer at the
+	// very end says how many entries the table has, which tells us how long it is. If the
+	// file is too short to have the table it says it has, it is corrupt.
+	//
+	holdingTrailer = false;
+
+	if (available() < (size_t)HuffmanFormat::SEEK_FOOTER_SIZE) // If there isn't room for a footer,
+	{
+		return false; // the file is corrupt.
+	}
+
+	const unsigned char* footer = (const unsigned char*)pending.data() + pending.size() - HuffmanFormat::SEEK_FOOTER_SIZE;
+
+	unsigned long long entryCount = 0;
+
+	for (int i = 0; i < 8; i++) // The entry count comes after the 4 byte interval, least significant byte first.
+	{
+		entryCount |= (unsigned long long)footer[4 + i] << (8 * i);
+	}
+
+	unsigned long long tableSize; // The size of the entries and the footer
+
+	if (!HuffmanFormat::seekTableSize(entryCount, available(), tableSize)) // If the entries don't fit,
+	{
+		return false; // the file is corrupt.
+	}
+
+	pending.resize(pending.size() - (size_t)tableSize); // Otherwise, we drop the table.
+
+	return true;
+}
+
+bool HuffmanStreamDecoder::decode(char* output, size_t capacity, size_t& written)
+{
+	// This method decodes symbols into the output until it is full, we run out of encoded bits,
+	// or we've decoded every symbol. Just like Huffman::decodeBytes, we follow the decoding table
+	// one bit at a time and write a symbol every time we reach a leaf. The node we are at and the
+	// bits of the current byte we haven't looked at are members, so we can stop anywhere and pick
+	// right back up on the next call. It returns whether we decoded anything or finished.
+	//
+	if (holdingTrailer) // If we need the end of the file to know where the encoded bits stop,
+	{
+		if (!finished) // but we don't have it yet,
+		{
+			return false; // we wait for it.
+		}
+
+		if (!dropTrailer()) // Once we have it, we drop the seek table. If we can't,
+		{
+			fail("The input has an invalid seek table."); // the file is corrupt.
+
+			return false;
+		}
+	}
+
+	if (symbolsLeft == 0) // If the original file was empty, there is nothing to decode.
+	{
+		state = DONE;
+
+		return true;
+	}
+
+	size_t start = written; // The amount of bytes in the output before we decoded anything
+
+	while (written < capacity) // While there is room in the output,
+	{
+		if (bitsLeft == 0) // if we've looked at every bit of the current byte,
+		{
+			if (blockSize != 0 && blockBytesLeft == 0) // and the block has no more bytes, but still has symbols, it's corrupt.
+			{
+				fail("The input has an invalid block.");
+
+				return false;
+			}
+
+			if (pendingStart == pending.size()) // If there are no more bytes,
+			{
+				if (finished) // then if nothing else is coming either, we've reached the end of the file.
+				{
+					if (symbolsLeft == HuffmanFormat::UNKNOWN_LENGTH) // If we didn't know how long the file was, that means we're done,
+					{
+						state = DONE;
+					}
+					else // but if we did, we should have stopped before now, so the file was cut off.
+					{
+						fail("The input is truncated.");
+					}
+
+					return true;
+				}
+
+				break; // Otherwise, we wait for more.
+			}
+
+			currentByte = pending[pendingStart++]; // Otherwise, we move on to the next byte,
+
+			bitsLeft = 8; // which has all 8 of its bits left.
+
+			if (blockSize != 0) // If the file is split into blocks, the byte is one less the block has left.
+			{
+				blockBytesLeft--;
+			}
+		}
+
+		bitsLeft--; // We look at the highest bit we haven't looked at yet,
+
+		currentNode = tables->children[currentNode][(currentByte >> bitsLeft) & 1]; // and go to the child it tells us to.
+
+		if (currentNode >= HuffmanTables::LEAF) // If we reached a leaf,
+		{
+			output[written++] = (char)(currentNode - HuffmanTables::LEAF); // we write its symbol,
+
+			currentNode = 0; // and start back at the root for the next one.
+
+			// If we know how many symbols there are and that was the last one, the rest of the bits are padding, so we're done.
+			if (symbolsLeft != HuffmanFormat::UNKNOWN_LENGTH && --symbolsLeft == 0)
+			{
+				state = DONE;
+
+				return true;
+			}
+
+			// If the file is split into blocks and that was the last symbol of the block, the rest of its bits are
+			// padding, so we move on to the next block, which starts with a byte of its own.
+			if (blockSize != 0 && --blockSymbolsLeft == 0)
+			{
+				bitsLeft = 0;
+
+				state = READING_BLOCK_HEADER;
+
+				return true;
+			}
+		}
+	}
+
+	return written > start;
+}
+
+bool HuffmanStreamDecoder::copy(char* output, size_t capacity, size_t& written)
+{
+	// This method copies the bytes of a stored file or block into the output until it is full, we
+	// run out of bytes, or we've copied the whole file or block. It returns whether we copied
+	// anything or finished.
+	//
+	size_t count = available(); // We copy every byte we have,
+
+	if (count > capacity - written) // as long as there is room for it,
+	{
+		count = capacity - written;
+	}
+
+	if (count > symbolsLeft) // and it's part of the original file,
+	{
+		count = (size_t)symbolsLeft;
+	}
+
+	if (blockSize != 0 && count > blockSymbolsLeft) // and of the current block, if the file is split into blocks.
+	{
+		count = (size_t)blockSymbolsLeft;
+	}
+
+	memcpy(output + written, pending.data() + pendingStart, count);
+
+	pendingStart += count;
+
+	written += count;
+
+	if (symbolsLeft != HuffmanFormat::UNKNOWN_LENGTH) // If we know how long the file is,
+	{
+		symbolsLeft -= count; // we count off the bytes we copied.
+	}
+
+	if (blockSize != 0) // If the file is split into blocks, we count them off of the block too.
+	{
+		blockSymbolsLeft -= count;
+		blockBytesLeft -= count;
+	}
+
+	if (symbolsLeft == 0) // If we've copied every byte, we're done.
+	{
+		state = DONE;
+
+		return true;
+	}
+
+	if (blockSize != 0 && blockSymbolsLeft == 0) // If we've copied every byte of the block, the next one comes next.
+	{
+		state = READING_BLOCK_HEADER;
+
+		return true;
+	}
+
+	if (available() == 0 && finished) // If we ran out of bytes and nothing else is coming, we've reached the end of the file.
+	{
+		if (symbolsLeft == HuffmanFormat::UNKNOWN_LENGTH) // If we didn't know how long the file was, that means we're done,
+		{
+			state = DONE;
+		}
+		else // but if we did, the file was cut off.
+		{
+			fail("The input is truncated.");
+		}
+
+		return true;
+	}
+
+	return count > 0;
+}
+
+void HuffmanStreamDecoder::fail(const string& reason)
+{
+	// This method stops decoding for the given reason. Nothing
+	// else will be decoded until the decoder is reset.
+	//
+	state = FAILED;
+
+	error = reason;
+}
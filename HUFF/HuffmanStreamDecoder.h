@@ -0,0 +1,78 @@
+//==============================================================================================
+// File: HuffmanStreamDecoder.h - Huffman streaming decoder
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <string>
+
+#include "Checksum.h"
+#include "Huffman.h"
+
+using namespace std;
+
+// Decodes a .huf file that arrives a piece at a time. Encoded bytes are fed in as they arrive
+// and decoded bytes are drained out as room for them becomes available, with everything about
+// where decoding stopped - including the bits of a code that hasn't been finished yet - kept
+// between calls. Neither call ever waits for more input.
+class HuffmanStreamDecoder {
+public:
+	HuffmanStreamDecoder();
+
+	void Feed(const char* data, size_t size); // Adds the given encoded bytes to the ones waiting to be decoded
+	void Finish(); // Says no more encoded bytes are coming, so whatever is left can be decoded and a cut off file can be noticed
+	size_t Drain(char* output, size_t capacity); // Decodes as much as it can, up to capacity bytes, into output, returning the amount of bytes decoded
+	void Reset(); // Gets ready to decode another file, keeping the tree in case it uses the same one
+	void SetTableCache(string directory); // Sets the directory of the table cache used to build trees, or an empty string for none
+	void SetChecksumCheck(bool enabled); // Sets whether files with a checksum fail if their output doesn't match it, which they do unless turned off
+
+	bool IsDone() const; // Returns whether every byte of the original file has been drained
+	bool HasFailed() const; // Returns whether the input can't be decoded, in which case GetError says why
+	const string& GetError() const; // Returns why the input can't be decoded, or an empty string if it can
+private:
+	enum decoderstate {
+		READING_HEADER,			// Waiting for the header, or the first bytes of a file without one
+		READING_TREE_BUILDER,	// Waiting for the 510 bytes of the tree builder, and the block size before it in files split into blocks
+		READING_BLOCK_HEADER,	// Waiting for the header of the next block, and its tree builder if it brings its own
+		DECODING,				// Decoding encoded bits
+		COPYING,				// Copying the bytes of a stored file
+		DONE,					// Every byte of the original file has been drained, and matched the checksum if the file has one
+		FAILED					// The input can't be decoded
+	};
+
+	Huffman huffman; // Builds the tables of the tree, so we get its tree memo and table cache too
+
+	decoderstate state;					// Where we are in the file
+	string pending;						// Bytes that have been fed in but not used yet, starting at pendingStart
+	size_t pendingStart;				// The position in pending of the next byte to use
+	bool finished;						// Whether we've been told no more bytes are coming
+	bool checkingChecksum;				// Whether we check the output against the checksum of files that have one
+	Crc32c checksum;					// The checksum of every byte drained from the current file
+	string error;						// Why the input can't be decoded, if it can't
+	HuffmanFormat::header fileHeader;	// The header of the file, or the defaults if it doesn't have one
+	bool holdingTrailer;				// Whether we have to wait for the end of the file to find where a seek table starts
+	const HuffmanTables* tables;		// The tables of the tree the file was encoded with
+	unsigned long long symbolsLeft;		// The amount of symbols left to decode, or UNKNOWN_LENGTH if the file doesn't say
+	unsigned short currentNode;			// The node of the tree we are at, partway through a code
+	unsigned char currentByte;			// The byte of encoded bits we are partway through
+	int bitsLeft;						// The amount of bits of the current byte we haven't looked at yet
+	unsigned int blockSize;				// The amount of symbols in each block, or 0 if the file isn't split into blocks
+	string sharedTreeBuilder;			// The tree builder bytes of the shared tree of a file split into blocks
+	string previousTreeBuilder;			// The tree builder bytes of the last block that brought its own tree, or an empty string if none has
+	unsigned long long blockSymbolsLeft; // The amount of symbols left to decode in the current block
+	unsigned long long blockBytesLeft;	// The amount of bytes of data left in the current block, which are skipped if its last symbol ends early
+
+	size_t available() const; // Returns the amount of bytes fed in but not used yet
+	bool readHeader(); // Reads the header if enough of it has arrived, returning whether we moved on
+	bool readTreeBuilder(); // Reads the tree builder and gets its tables if all of it has arrived, returning whether we moved on
+	bool readBlockHeader(); // Skips what's left of the last block, then reads the header of the next one and gets its tables if all of it has arrived, returning whether anything happened
+	bool dropTrailer(); // Removes the seek table from the end of the pending bytes once we have all of them, returning false if it is corrupt
+	bool decode(char* output, size_t capacity, size_t& written); // Decodes symbols until the output is full or we run out of bits, returning whether anything happened
+	bool copy(char* output, size_t capacity, size_t& written); // Copies stored bytes until the output is full or we run out of them, returning whether anything happened
+	void fail(const string& reason); // Stops decoding for the given reason
+};
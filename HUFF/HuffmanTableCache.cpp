@@ -0,0 +1,301 @@
+//==============================================================================================
+// File: HuffmanTableCache.cpp - Huffman table cache implementation
+// c.f.: HuffmanTableCache.h
+//
+// This class keeps the built tables of every tree it is given in a directory, so files that
+// share a tree only pay for building it once. Each cache file is named after a hash of the
+// tree builder bytes it was built from and holds them too, so two trees with the same hash
+// can never be mixed up. Files are written under a temporary name and renamed into place,
+// so processes sharing a cache directory never see a half written file. Anyone who can write
+// to the directory can change the tables, though, so before we use a file we check that its
+// tables really are the ones its tree builder builds.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "HuffmanTableCache.h"
+#include "HuffmanTreeBuilder.h"
+
+const unsigned char HuffmanTableCache::MAGIC[4] = { 'H', 'T', 'A', 'B' };
+
+HuffmanTableCache::HuffmanTableCache(string directory) : directory(directory)
+{
+	// The constructor. We don't look at the directory until we are asked for
+	// tables, since most trees are only ever looked up once per process.
+	//
+}
+
+HuffmanTableCache::~HuffmanTableCache()
+{
+	// In the destructor, we unmap every table we've mapped. Nobody can
+	// be using them anymore, since they go away along with the cache.
+	//
+	for (auto& entry : mappedTables)
+	{
+		unmapFile(entry.second);
+	}
+}
+
+const HuffmanTables* HuffmanTableCache::Find(const string& treeBuilder)
+{
+	// This method returns the cached tables for the given tree builder bytes. If we've
+	// already mapped them, we just hand them back. Otherwise, we map the cache file for
+	// the bytes, if there is one, and make sure it really holds their tables before
+	// keeping it. If there is no usable cache file, we return nullptr.
+	//
+	auto found = mappedTables.find(treeBuilder);
+
+	if (found != mappedTables.end()) // If we've mapped these tables before,
+	{
+		return found->second; // they are still mapped, so we're done.
+	}
+
+	const HuffmanTables* tables = mapFile(getPath(treeBuilder)); // Otherwise, we map the cache file.
+
+	if (tables == nullptr) // If there isn't one,
+	{
+		return nullptr; // the tree hasn't been cached yet.
+	}
+
+	if (!isValid(*tables, treeBuilder)) // If the file is for a different tree, or was written by a different machine or version,
+	{
+		unmapFile(tables); // we can't use it.
+
+		return nullptr;
+	}
+
+	mappedTables[treeBuilder] = tables; // Otherwise, we keep it mapped for next time,
+
+	return tables; // and hand it back.
+}
+
+void HuffmanTableCache::Store(const HuffmanTables& tables)
+{
+	// This method writes the given tables to the cache. We write them to a temporary file
+	// named after our process and thread first, then rename it into place, so anyone looking
+	// the tables up at the same time either finds the whole file or no file at all. The cache
+	// is only there to save time, so if we can't write to it, we just leave it alone.
+	//
+	string treeBuilder((const char*)tables.treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE);
+
+	string path = getPath(treeBuilder);
+
+	// Every worker of a daemon has its own cache in the same directory, so two of them can store the same tables at once.
+	string threadName = to_string(hash<thread::id>()(this_thread::get_id()));
+
+#ifdef _WIN32
+	string temporaryPath = path + "." + to_string(_getpid()) + "." + threadName + ".tmp";
+#else
+	string temporaryPath = path + "." + to_string(getpid()) + "." + threadName + ".tmp";
+#endif
+
+	ofstream file(temporaryPath, ios::out | ios::trunc | ios::binary);
+
+	file.write((const char*)&tables, sizeof(HuffmanTables)); // Write the tables exactly as they are laid out in memory.
+
+	file.close();
+
+	// If we couldn't write the whole file, or couldn't rename it because another process stored the
+	// same tables first, we get rid of the temporary file.
+	if (!file || rename(temporaryPath.c_str(), path.c_str()) != 0)
+	{
+		remove(temporaryPath.c_str());
+	}
+}
+
+const string& HuffmanTableCache::GetDirectory() const
+{
+	// This method returns the directory the cache files are in.
+	//
+	return directory;
+}
+
+string HuffmanTableCache::getPath(const string& treeBuilder)
+{
+	// This method returns the path of the cache file for the given tree builder bytes,
+	// which is named after their 64 bit FNV-1a hash written out in hexadecimal.
+	//
+	unsigned long long hash = 14695981039346656037ull; // The FNV offset basis
+
+	for (unsigned int i = 0; i < treeBuilder.length(); i++)
+	{
+		hash ^= (unsigned char)treeBuilder[i];	// Mix in each byte,
+		hash *= 1099511628211ull;				// and multiply by the FNV prime.
+	}
+
+	char name[32];
+
+	snprintf(name, sizeof(name), "%016llx.htab", hash);
+
+	return directory + "/" + name;
+}
+
+const HuffmanTables* HuffmanTableCache::mapFile(const string& path)
+{
+	// This method maps the file at the given path into memory as read only tables. If the
+	// file doesn't exist, can't be mapped, or isn't exactly the size of the tables, we
+	// return nullptr. The mapping stays valid after the file is closed.
+	//
+	const HuffmanTables* tables = nullptr;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER size;
+
+	if (GetFileSizeEx(file, &size) && size.QuadPart == sizeof(HuffmanTables))
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping != nullptr)
+		{
+			tables = (const HuffmanTables*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(HuffmanTables));
+
+			CloseHandle(mapping);
+		}
+	}
+
+	CloseHandle(file);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+
+	if (file < 0)
+	{
+		return nullptr;
+	}
+
+	struct stat status;
+
+	if (fstat(file, &status) == 0 && status.st_size == sizeof(HuffmanTables))
+	{
+		void* mapping = mmap(nullptr, sizeof(HuffmanTables), PROT_READ, MAP_SHARED, file, 0);
+
+		if (mapping != MAP_FAILED)
+		{
+			tables = (const HuffmanTables*)mapping;
+		}
+	}
+
+	close(file);
+#endif
+
+	return tables;
+}
+
+void HuffmanTableCache::unmapFile(const HuffmanTables* tables)
+{
+	// This method unmaps tables that were mapped by mapFile.
+	//
+#ifdef _WIN32
+	UnmapViewOfFile(tables);
+#else
+	munmap((void*)tables, sizeof(HuffmanTables));
+#endif
+}
+
+bool HuffmanTableCache::isValid(const HuffmanTables& tables, const string& treeBuilder)
+{
+	// This method checks whether the given tables can be used for the given tree builder
+	// bytes. They have to be in the layout and byte order we use and built from exactly
+	// the same bytes. Since the decoding tree is followed without any other checks, we
+	// also make sure every child is either an internal node or a leaf, so a damaged file
+	// can never send the decoder outside of the table.
+	//
+	// Matching tree builder bytes don't mean the rest of the file matches them, so we also
+	// check the tables against the tree. The tree builder has to describe a tree, which
+	// means every combination takes two slots that still hold a node, lower one first. The length
+	// of every code has to be the one the tree gives it. And the bits of every code have to
+	// lead down the decoding tree to the leaf of its symbol, in exactly that many steps,
+	// without reaching another leaf on the way. Every string of bits starts with one of the
+	// codes of a tree, so that covers every path the decoder can ever take.
+	//
+	if (memcmp(tables.magic, MAGIC, sizeof(MAGIC)) != 0 || tables.byteOrder != BYTE_ORDER_MARK || tables.version != VERSION)
+	{
+		return false;
+	}
+
+	if (memcmp(tables.treeBuilder, treeBuilder.data(), HuffmanFormat::TREE_BUILDER_SIZE) != 0)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < 255; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			unsigned short child = tables.children[i][j];
+
+			if (child >= 255 && (child < HuffmanTables::LEAF || child >= HuffmanTables::LEAF + 256))
+			{
+				return false;
+			}
+		}
+	}
+
+	vector<HuffmanTreeBuilder::merge> merges; // The combinations the tree builder describes
+
+	for (int i = 0; i < 255; i++)
+	{
+		merges.push_back({ tables.treeBuilder[2 * i], tables.treeBuilder[2 * i + 1] });
+	}
+
+	if (!HuffmanTreeBuilder::IsValid(merges, 256)) // If they don't build a tree, the way Huffman checks them before it builds one,
+	{
+		return false; // no tables are for them.
+	}
+
+	vector<unsigned int> lengths = HuffmanTreeBuilder::CodeLengths(merges, 256);
+
+	for (int symbol = 0; symbol < 256; symbol++)
+	{
+		if (tables.lengths[symbol] != lengths[symbol]) // If the code isn't as long as the tree makes it,
+		{
+			return false; // the tables are for some other tree.
+		}
+
+		unsigned short node = 0; // We follow the code down the decoding tree from the root.
+
+		for (unsigned int j = 0; j < lengths[symbol]; j++)
+		{
+			if (node >= HuffmanTables::LEAF) // If we reached a leaf before the end of the code, the code is wrong.
+			{
+				return false;
+			}
+
+			node = tables.children[node][(tables.codes[symbol][j / 8] >> (7 - j % 8)) & 1];
+		}
+
+		if (node != HuffmanTables::LEAF + symbol) // At the end of it, we have to be at the leaf of the symbol.
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
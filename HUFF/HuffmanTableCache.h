@@ -0,0 +1,57 @@
+//==============================================================================================
+// File: HuffmanTableCache.h - Huffman table cache
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "HuffmanFormat.h"
+
+using namespace std;
+
+// The fully built encoding and decoding tables of one tree. Everything is a fixed size array,
+// so a cache file is exactly this struct and can be used straight out of a memory mapping.
+struct HuffmanTables {
+	const static unsigned short LEAF = 256;	// Children at or above this are leaves, holding their symbol plus LEAF
+	const static int CODE_BYTES = 32;		// The amount of bytes each code is stored in, enough for the longest possible code of 255 bits
+
+	unsigned char magic[4];		// The magic bytes of a cache file, so other files are never used as tables
+	unsigned short byteOrder;	// The byte order mark as written by the machine that built the tables, so other machines don't use them
+	unsigned short version;		// The version of this layout
+	unsigned char treeBuilder[HuffmanFormat::TREE_BUILDER_SIZE];	// The tree builder bytes the tables were built from
+	unsigned char lengths[256];					// The length in bits of the code of each symbol
+	unsigned char codes[256][CODE_BYTES];		// The bits of each code, starting at the highest bit of the first byte
+	unsigned short children[255][2];			// The left and right child of each internal node, with the root at 0
+};
+
+// A directory of built tables, named after a hash of their tree builder bytes. Tables are
+// mapped into memory the first time they are asked for, and stay mapped until the cache is
+// destroyed, so a tree that was built once, by any process, is never built again.
+class HuffmanTableCache {
+public:
+	HuffmanTableCache(string directory);
+	~HuffmanTableCache();
+
+	const HuffmanTables* Find(const string& treeBuilder); // Returns the cached tables for the given tree builder bytes, or nullptr if there are none
+	void Store(const HuffmanTables& tables); // Writes the given tables to the cache, so later lookups for their tree builder find them
+	const string& GetDirectory() const; // Returns the directory the cache files are in
+
+	static const unsigned char MAGIC[4];				// The bytes every cache file starts with
+	const static unsigned short BYTE_ORDER_MARK = 0x0102;	// Reads back differently on a machine with the other byte order
+	const static unsigned short VERSION = 1;			// The version of the table layout written by this program
+private:
+	string directory;	// The directory the cache files are in
+	map<string, const HuffmanTables*> mappedTables; // The tables we've mapped so far, keyed by tree builder bytes
+
+	string getPath(const string& treeBuilder); // Returns the path of the cache file for the given tree builder bytes
+	static const HuffmanTables* mapFile(const string& path); // Maps the given file into memory, returning nullptr if it can't be or is the wrong size
+	static void unmapFile(const HuffmanTables* tables); // Unmaps tables mapped by mapFile
+	static bool isValid(const HuffmanTables& tables, const string& treeBuilder); // Checks whether the given tables are for the given tree builder bytes and safe to decode with
+};
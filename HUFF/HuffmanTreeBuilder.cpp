@@ -0,0 +1,123 @@
+//==============================================================================================
+// File: HuffmanTreeBuilder.cpp - Huffman tree construction for any alphabet implementation
+// c.f.: HuffmanTreeBuilder.h
+//
+// Finding the two lightest nodes by looking through every slot takes time proportional to the
+// size of the alphabet, and we have to do it once per combination, so building a tree that way
+// takes time proportional to the square of the alphabet size. That's fine for 256 symbols, but
+// not for alphabets like 16 bit symbols. Instead, we keep the nodes in a min heap keyed by their
+// weight and then their slot, which is exactly the order the slot by slot search picks them in,
+// so the tree comes out the same and only takes time proportional to n log n. The rest of the
+// program still only codes bytes, as HuffmanTreeBuilder.h explains.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "HuffmanTreeBuilder.h"
+
+vector<HuffmanTreeBuilder::merge> HuffmanTreeBuilder::Build(const unsigned long long* weights, size_t symbolCount)
+{
+	// This method works out which nodes to combine to build the Huffman tree. Every symbol starts
+	// out as a node in its own slot. We take the lightest node out of the heap, then the next
+	// lightest, and put their parent back in with the sum of their weights, in the lower of their
+	// two slots. The slot of a node is part of its key, so when weights are equal, the node in the
+	// lower slot comes out first. We are done once only the root is left.
+	//
+	typedef pair<unsigned long long, unsigned int> entry; // The weight and slot of a node in the heap
+
+	vector<entry> entries; // Every symbol, which we turn into a heap all at once
+
+	entries.reserve(symbolCount);
+
+	for (size_t i = 0; i < symbolCount; i++)
+	{
+		entries.push_back(entry(weights[i], (unsigned int)i));
+	}
+
+	// A priority queue with greater puts the smallest key on top, and comparing pairs compares their weights first, then their slots.
+	priority_queue<entry, vector<entry>, greater<entry>> heap(greater<entry>(), move(entries));
+
+	vector<merge> merges; // The combinations, in the order we make them
+
+	merges.reserve(symbolCount > 0 ? symbolCount - 1 : 0);
+
+	while (heap.size() > 1) // While there is more than one node left,
+	{
+		entry smallest = heap.top(); // we take the lightest node,
+
+		heap.pop();
+
+		entry nextSmallest = heap.top(); // and the next lightest.
+
+		heap.pop();
+
+		merge combination; // The node in the lower slot is always the left child, and its slot is where the parent goes.
+
+		combination.left = smallest.second < nextSmallest.second ? smallest.second : nextSmallest.second;
+		combination.right = smallest.second < nextSmallest.second ? nextSmallest.second : smallest.second;
+
+		merges.push_back(combination);
+
+		heap.push(entry(smallest.first + nextSmallest.first, combination.left)); // The parent weighs as much as both of its children.
+	}
+
+	return merges;
+}
+
+vector<unsigned int> HuffmanTreeBuilder::CodeLengths(const vector<merge>& merges, size_t symbolCount)
+{
+	// This method works out how long the code of every symbol is, without building any nodes,
+	// so large alphabets don't need a node for every symbol. The root ends up in the lowest slot
+	// with a depth of 0. Going through the combinations backwards, each one splits the node in
+	// its left slot back into its two children, one level deeper than it. Once we're back to
+	// the start, each slot holds its symbol, at the depth of its leaf, which is its code length.
+	//
+	vector<unsigned int> depths(symbolCount, 0); // The depth of the node in each slot
+
+	for (size_t i = merges.size(); i > 0; i--)
+	{
+		const merge& combination = merges[i - 1];
+
+		unsigned int childDepth = depths[combination.left] + 1;
+
+		depths[combination.left] = childDepth;
+		depths[combination.right] = childDepth;
+	}
+
+	return depths;
+}
+
+bool HuffmanTreeBuilder::IsValid(const vector<merge>& merges, size_t symbolCount)
+{
+	// This method checks that the given combinations, which usually come from a file, build a
+	// tree. There has to be one combination for every symbol but the root, and each one has to
+	// take two slots that still hold a node, listing the lower slot first, just like Build does.
+	// Anything else either doesn't build a tree, or builds one no tree builder would describe
+	// that way, so everything that checks combinations agrees on which ones are valid.
+	//
+	if (merges.size() + 1 != symbolCount)
+	{
+		return false;
+	}
+
+	vector<bool> occupied(symbolCount, true); // Whether each slot still holds a node
+
+	for (const merge& combination : merges)
+	{
+		if (combination.left >= combination.right || combination.right >= symbolCount || !occupied[combination.left] || !occupied[combination.right])
+		{
+			return false;
+		}
+
+		occupied[combination.right] = false; // The parent takes the left slot, so the right one is empty from now on.
+	}
+
+	return true;
+}
@@ -0,0 +1,37 @@
+//==============================================================================================
+// File: HuffmanTreeBuilder.h - Huffman tree construction for any alphabet
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+// Works out the order nodes are combined in to build a Huffman tree for an alphabet of any size,
+// from the weight of each symbol. Every node lives in a slot, starting with each symbol in the slot
+// of the same number. Each combination takes the two lightest nodes, breaking ties by the lower slot,
+// and puts their parent in the lower of their two slots. For 256 symbols, the slots of each combination
+// are exactly the pairs of bytes in a tree builder file.
+//
+// Only building the tree and working out its code lengths works for any alphabet. Everything else
+// still codes bytes: the Huffman class counts into 256 entry arrays, HuffmanTables and the codebook
+// headers have a row per byte, and a tree builder file stores each slot in one byte. So for now, the
+// only alphabet the program actually codes with is 256 symbols, and larger ones would need a new file
+// format with wider slots before any of that could use them.
+class HuffmanTreeBuilder {
+public:
+	struct merge {
+		unsigned int left;	// The slot of the left child, which the parent takes over
+		unsigned int right;	// The slot of the right child, which is empty afterwards
+	};
+
+	static vector<merge> Build(const unsigned long long* weights, size_t symbolCount); // Returns the combinations that build the tree for symbols with the given weights
+	static vector<unsigned int> CodeLengths(const vector<merge>& merges, size_t symbolCount); // Returns the length of the code of each symbol in the tree the given combinations build
+	static bool IsValid(const vector<merge>& merges, size_t symbolCount); // Checks whether the given combinations build a tree, in the order Build would list their slots
+};
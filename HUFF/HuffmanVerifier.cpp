@@ -0,0 +1,203 @@
+//==============================================================================================
+// File: HuffmanVerifier.cpp - Huffman round trip verifier implementation
+// c.f.: HuffmanVerifier.h
+//
+// This class sits between the encoder and its output. Each time its buffer fills up, the bytes
+// are written to the real output and a copy is queued for a thread that feeds them to a stream
+// decoder, so decoding runs alongside encoding instead of after it. Nothing decoded is kept:
+// we only add it to a checksum and count it. The queue only holds a few chunks, so if decoding
+// ever falls behind, encoding waits for it instead of using more and more memory.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include "HuffmanVerifier.h"
+
+HuffmanVerifier::HuffmanVerifier(streambuf* destination) : destination(destination), buffer(65536)
+{
+	// The constructor. The whole buffer is our put area, so nothing is passed on
+	// until it fills up or we are flushed. The decoding thread starts right away
+	// and waits for the first chunk. The checksum in the header we decode is only a placeholder
+	// until encoding is done, so the decoder doesn't check it, and we compare our own instead.
+	//
+	setp(buffer.data(), buffer.data() + buffer.size());
+
+	decoder.SetChecksumCheck(false);
+
+	finished = false;
+
+	decodedLength = 0;
+
+	decodingThread = thread(&HuffmanVerifier::decoderLoop, this);
+}
+
+HuffmanVerifier::~HuffmanVerifier()
+{
+	// The destructor. If Finish was never called, we still have to stop the
+	// decoding thread before it goes away, so we tell it we're done and wait.
+	//
+	if (decodingThread.joinable())
+	{
+		{
+			lock_guard<mutex> lock(chunksMutex);
+
+			finished = true;
+		}
+
+		chunksChanged.notify_all();
+
+		decodingThread.join();
+	}
+}
+
+string HuffmanVerifier::Finish(unsigned int expectedChecksum, unsigned long long expectedLength)
+{
+	// This method passes on whatever is still buffered, tells the decoding thread nothing
+	// else is coming, and waits for it to decode the rest. Then we compare what it decoded
+	// with the input, returning why they don't match, or an empty string if they do.
+	//
+	passOn();
+
+	{
+		lock_guard<mutex> lock(chunksMutex);
+
+		finished = true;
+	}
+
+	chunksChanged.notify_all();
+
+	decodingThread.join(); // Once the thread is done, everything it decoded has been counted.
+
+	if (decoder.HasFailed()) // If the output couldn't be decoded,
+	{
+		return "The output can't be decoded: " + decoder.GetError(); // we say why.
+	}
+
+	if (!decoder.IsDone() || decodedLength != expectedLength) // If it decoded to a different length,
+	{
+		return "The output decodes to " + to_string(decodedLength) + " bytes instead of " + to_string(expectedLength) + ".";
+	}
+
+	if (checksum.GetValue() != expectedChecksum) // If it decoded to different bytes,
+	{
+		return "The output doesn't decode to the input.";
+	}
+
+	return "";
+}
+
+HuffmanVerifier::int_type HuffmanVerifier::overflow(int_type character)
+{
+	// This method gets called when the put area is full. We pass everything in it on,
+	// then put the given character at the beginning of the now empty put area.
+	//
+	if (!passOn())
+	{
+		return traits_type::eof();
+	}
+
+	if (!traits_type::eq_int_type(character, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(character);
+
+		pbump(1);
+	}
+
+	return traits_type::not_eof(character);
+}
+
+int HuffmanVerifier::sync()
+{
+	// This method gets called when the stream is flushed. We pass
+	// everything we have on and flush the destination too.
+	//
+	return passOn() ? destination->pubsync() : -1;
+}
+
+bool HuffmanVerifier::passOn()
+{
+	// This method writes everything in the put area to the destination, then queues a copy
+	// of it for the decoding thread. If the queue is full, we wait for the decoder to take a
+	// chunk first. The put area is left empty.
+	//
+	streamsize count = pptr() - pbase();
+
+	if (count == 0) // If there is nothing to pass on,
+	{
+		return true; // we're done.
+	}
+
+	bool written = destination->sputn(pbase(), count) == count;
+
+	{
+		unique_lock<mutex> lock(chunksMutex);
+
+		chunksChanged.wait(lock, [this] { return chunks.size() < MAX_QUEUED_CHUNKS; });
+
+		chunks.push(string(pbase(), (size_t)count));
+	}
+
+	chunksChanged.notify_all();
+
+	setp(buffer.data(), buffer.data() + buffer.size());
+
+	return written;
+}
+
+void HuffmanVerifier::decoderLoop()
+{
+	// This method runs on the decoding thread. We take chunks off of the queue as they
+	// arrive and feed them to the decoder, decoding as much as we can after each one.
+	// Once everything has been written and the queue is empty, we tell the decoder
+	// nothing else is coming and decode whatever is left.
+	//
+	while (true)
+	{
+		string chunk;
+
+		{
+			unique_lock<mutex> lock(chunksMutex);
+
+			chunksChanged.wait(lock, [this] { return !chunks.empty() || finished; });
+
+			if (chunks.empty()) // If there are no chunks left and nothing else is coming,
+			{
+				break; // we're done waiting.
+			}
+
+			chunk.swap(chunks.front()); // Otherwise, we take the next chunk.
+
+			chunks.pop();
+		}
+
+		chunksChanged.notify_all(); // The writer may be waiting for room in the queue.
+
+		decoder.Feed(chunk.data(), chunk.size());
+
+		drainDecoder();
+	}
+
+	decoder.Finish();
+
+	drainDecoder();
+}
+
+void HuffmanVerifier::drainDecoder()
+{
+	// This method decodes everything the decoder can with what it's been fed, adding
+	// every decoded byte to the checksum and length instead of keeping it.
+	//
+	char decoded[65536];
+
+	size_t count;
+
+	while ((count = decoder.Drain(decoded, sizeof(decoded))) > 0)
+	{
+		checksum.Update(decoded, count);
+
+		decodedLength += count;
+	}
+}
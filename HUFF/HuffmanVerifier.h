@@ -0,0 +1,58 @@
+//==============================================================================================
+// File: HuffmanVerifier.h - Huffman round trip verifier
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Checksum.h"
+#include "HuffmanStreamDecoder.h"
+
+using namespace std;
+
+// A write only stream buffer that passes everything written to it on to another stream buffer,
+// while a thread of its own decodes a copy of it in memory. Once encoding is done, the checksum
+// and length of what was decoded can be compared with the input, so every encoded file is known
+// to decode correctly without writing it out a second time or reading it back.
+class HuffmanVerifier : public streambuf {
+public:
+	HuffmanVerifier(streambuf* destination); // Makes a stream buffer that writes to the given one, and starts its decoding thread
+	~HuffmanVerifier();
+
+	// Waits for everything written to be decoded, then returns why it doesn't match the given
+	// checksum and length of the input, or an empty string if it does.
+	string Finish(unsigned int expectedChecksum, unsigned long long expectedLength);
+
+	const static int MAX_QUEUED_CHUNKS = 16; // The amount of chunks that can wait to be decoded before writing waits for the decoder
+protected:
+	int_type overflow(int_type character) override; // Passes the buffered bytes on when the buffer is full, then buffers the given character
+	int sync() override; // Passes the buffered bytes on and flushes the destination
+private:
+	streambuf* destination;	// The stream buffer we write to
+	vector<char> buffer;	// The bytes written but not passed on yet
+
+	mutex chunksMutex;						// Guards the chunks and finished flag below
+	condition_variable chunksChanged;		// Wakes the decoding thread when a chunk is added, and the writer when one is taken
+	queue<string> chunks;					// Copies of the chunks passed on that haven't been decoded yet
+	bool finished;							// Whether everything has been written, so the decoder should finish once the chunks run out
+
+	HuffmanStreamDecoder decoder;		// Decodes the chunks
+	Crc32c checksum;					// The checksum of everything decoded
+	unsigned long long decodedLength;	// The amount of bytes decoded
+	thread decodingThread;				// Runs decoderLoop
+
+	bool passOn(); // Writes the buffered bytes to the destination and queues a copy for the decoder, returning false if the destination can't take them
+	void decoderLoop(); // Decodes chunks as they are queued until everything has been written
+	void drainDecoder(); // Decodes everything the decoder can, adding it to the checksum and length
+};
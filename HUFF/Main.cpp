@@ -13,8 +13,11 @@
 // Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
 
 #include <iostream>
+#include <climits>
+#include <thread>
 
 #include "Huffman.h"
+#include "HuffmanDaemon.h"
 
 using namespace std;
 
@@ -40,6 +43,174 @@ string replaceExtension(const string& fileName, const string& extension)
 	}
 }
 
+bool parseNumber(const string& text, unsigned long long& number)
+{
+	// This method parses the given text as a whole number, putting it into
+	// the given number. If the text is empty, has anything other than digits
+	// in it, or is too large to fit, we return false.
+	//
+	if (text.empty()) // If there is no text,
+	{
+		return false; // there is no number to parse.
+	}
+
+	number = 0; // We build the number up one digit at a time, starting from 0.
+
+	for (unsigned int i = 0; i < text.length(); i++) // Loop through every character of the text,
+	{
+		if (text[i] < '0' || text[i] > '9') // and if it isn't a digit,
+		{
+			return false; // the text isn't a number.
+		}
+
+		unsigned int digit = text[i] - '0'; // Otherwise, we turn the character into the digit it represents.
+
+		if (number > (ULLONG_MAX - digit) / 10) // If adding the digit would make the number too large to fit,
+		{
+			return false; // we can't parse it.
+		}
+
+		number = number * 10 + digit; // Shift the number over a digit and add the new one on the end.
+	}
+
+	return true; // We made it through every character, so the number is valid!
+}
+
+// The options that set up the daemon. The daemon isn't made until every option has been
+// handled, so we keep them here until then.
+struct daemonoptions {
+	unsigned long long maxOutputSize = HuffmanDaemon::DEFAULT_MAX_OUTPUT_SIZE; // The largest response payload the daemon sends
+	string treeDirectory; // The directory the daemon reads tree files from, or an empty string if it refuses them
+};
+
+bool handleOptions(int& argc, char* argv[], Huffman* huffman, daemonoptions& daemonOptions)
+{
+	// This method handles the options given after the flag. Options start with
+	// two dashes and can be placed anywhere after the flag. We apply each one to
+	// the Huffman instance and remove it from the arguments, so every other argument
+	// ends up in the position the flags below expect. If an option is invalid, we
+	// print out why and return false.
+	//
+	int kept = 2; // The amount of arguments we are keeping. We always keep the executable path and the flag.
+
+	for (int i = 2; i < argc; i++) // Loop through every argument after the flag.
+	{
+		string argument = argv[i];
+
+		if (argument.compare(0, 2, "--") != 0) // If the argument doesn't start with two dashes, it isn't an option,
+		{
+			argv[kept] = argv[i]; // so we keep it, moving it back over any options before it.
+
+			kept++;
+
+			continue;
+		}
+
+		// Options can have a value after an equals sign, so we split the option into its name and value.
+		size_t equalsPosition = argument.find('=');
+
+		string name = argument.substr(2, equalsPosition == string::npos ? string::npos : equalsPosition - 2);
+
+		string value = equalsPosition == string::npos ? "" : argument.substr(equalsPosition + 1);
+
+		if (name == "index") // If the option is index, we are going to write a seek table when encoding.
+		{
+			unsigned long long interval = Huffman::DEFAULT_SEEK_INTERVAL; // Unless we are given an interval, we use the default one.
+
+			// If we were given an interval, but it isn't a number, is 0, or is too large, it is invalid.
+			if (equalsPosition != string::npos && (!parseNumber(value, interval) || interval == 0 || interval > UINT_MAX))
+			{
+				cout << "Invalid seek table interval!" << endl;
+
+				return false;
+			}
+
+			huffman->SetSeekInterval((unsigned int)interval); // Otherwise, we tell our Huffman instance to use it.
+		}
+		else if (name == "cache") // If the option is cache, we are going to keep built tables in the given directory.
+		{
+			if (value.empty()) // If we weren't given a directory, the option is invalid.
+			{
+				cout << "Missing table cache directory!" << endl;
+
+				return false;
+			}
+
+			huffman->SetTableCache(value); // Otherwise, we tell our Huffman instance to use it.
+		}
+		else if (name == "sample") // If the option is sample, we are going to build the tree from a sample of large inputs when encoding.
+		{
+			unsigned long long size = Huffman::DEFAULT_SAMPLE_SIZE; // Unless we are given a size, we use the default one.
+
+			// If we were given a size, but it isn't a number or is 0, it is invalid.
+			if (equalsPosition != string::npos && (!parseNumber(value, size) || size == 0))
+			{
+				cout << "Invalid sample size!" << endl;
+
+				return false;
+			}
+
+			huffman->SetSampleSize(size); // Otherwise, we tell our Huffman instance to use it.
+		}
+		else if (name == "blocks") // If the option is blocks, we are going to split the input into blocks when encoding.
+		{
+			unsigned long long size = Huffman::DEFAULT_BLOCK_SIZE; // Unless we are given a size, we use the default one.
+
+			// If we were given a size, but it isn't a number, is too small to pay off, or is too large for a block header, it is invalid.
+			if (equalsPosition != string::npos && (!parseNumber(value, size) || size < Huffman::MIN_BLOCK_SIZE || size > HuffmanFormat::MAX_BLOCK_SIZE))
+			{
+				cout << "Invalid block size!" << endl;
+
+				return false;
+			}
+
+			huffman->SetBlockSize((unsigned int)size); // Otherwise, we tell our Huffman instance to use it.
+		}
+		else if (name == "max-output") // If the option is max-output, the daemon will refuse to send responses larger than the given size.
+		{
+			unsigned long long size;
+
+			// If we weren't given a size, or it isn't a number, is 0, or is too large to fit in a frame, it is invalid.
+			if (!parseNumber(value, size) || size == 0 || size > HuffmanDaemon::MAX_OUTPUT_LIMIT)
+			{
+				cout << "Invalid output limit!" << endl;
+
+				return false;
+			}
+
+			daemonOptions.maxOutputSize = size; // Otherwise, we keep it for the daemon.
+		}
+		else if (name == "trees") // If the option is trees, the daemon will read the tree files clients ask for from the given directory.
+		{
+			if (value.empty()) // If we weren't given a directory, the option is invalid.
+			{
+				cout << "Missing tree directory!" << endl;
+
+				return false;
+			}
+
+			daemonOptions.treeDirectory = value; // Otherwise, we keep it for the daemon.
+		}
+		else if (name == "crc") // If the option is crc, we are going to write the checksum of the input when encoding.
+		{
+			huffman->SetChecksum(true);
+		}
+		else if (name == "verify") // If the option is verify, we are going to check that what we encode decodes to the input.
+		{
+			huffman->SetVerify(true);
+		}
+		else
+		{
+			cout << "Invalid option: " << argument << endl; // Otherwise, we don't know the option, so we say so.
+
+			return false;
+		}
+	}
+
+	argc = kept; // Now the only arguments left are the ones we kept.
+
+	return true;
+}
 
 void handleCommandLineParameters(int argc, char* argv[], Huffman* huffman)
 {
@@ -73,6 +244,13 @@ void handleCommandLineParameters(int argc, char* argv[], Huffman* huffman)
 
 	string command = flag.substr(1); // Since the flag will always start with a dash, we strip it out and just focus on the command.
 
+	daemonoptions daemonOptions; // The options for the daemon, if we end up running one
+
+	if (!handleOptions(argc, argv, huffman, daemonOptions)) // We apply any options and remove them from the arguments. If any of them are invalid,
+	{
+		return; // we're done here, so now we return.
+	}
+
 	if (command == "h" || command == "?" || command == "help") // If the command is h, ?, or help,
 	{
 		huffman->DisplayHelp(); // we just display the help and we're done.
@@ -107,6 +285,63 @@ void handleCommandLineParameters(int argc, char* argv[], Huffman* huffman)
 			huffman->DecodeFile(argv[2], argv[3]);
 		}
 	}
+	else if (command == "g") // If the command is g, we are going to make a codebook header from a tree builder file.
+	{
+		if (argc < 4) // If we have less than 4 arguments, we are missing the tree builder or header file path,
+		{
+			cout << "Missing arguments!" << endl; // so we print that we are missing arguments.
+		}
+		else // otherwise,
+		{
+			// we tell our Huffman instance to make the header, naming the codebook after the 4th argument if we have one.
+			huffman->MakeCodebookHeader(argv[2], argv[3], argc < 5 ? "HuffmanCodebook" : argv[4]);
+		}
+	}
+	else if (command == "s") // If the command is s, we are going to run as a daemon, servicing requests on a socket.
+	{
+		unsigned long long workerCount = thread::hardware_concurrency(); // By default, we have one worker for each hardware thread.
+
+		if (argc < 3) // If we have less than 3 arguments, we are missing the socket path,
+		{
+			cout << "Missing arguments!" << endl; // so we print that we are missing arguments.
+		}
+		else if (argc >= 4 && (!parseNumber(argv[3], workerCount) || workerCount == 0 || workerCount > 1024)) // If the worker count isn't a reasonable number,
+		{
+			cout << "Invalid worker count!" << endl; // we print that it is invalid.
+		}
+		else // otherwise,
+		{
+			// we construct a daemon listening on the socket path, and run it until we are interrupted.
+			HuffmanDaemon daemon(argv[2], (unsigned int)workerCount);
+
+			daemon.SetMaxOutputSize(daemonOptions.maxOutputSize);
+
+			daemon.SetTreeDirectory(daemonOptions.treeDirectory);
+
+			daemon.SetSettings(huffman); // Every other option applies to the requests, so the workers copy them from our instance.
+
+			daemon.Run();
+		}
+	}
+	else if (command == "r") // If the command is r, we are going to decode a range of a file.
+	{
+		unsigned long long offset; // The position in the original file of the first byte we want
+		unsigned long long length; // The amount of bytes we want
+
+		if (argc < 6) // If we have less than 6 arguments, we are missing the file paths, offset or length,
+		{
+			cout << "Missing arguments!" << endl; // so we print that we are missing arguments.
+		}
+		else if (!parseNumber(argv[4], offset) || !parseNumber(argv[5], length)) // If the offset or length aren't numbers,
+		{
+			cout << "Invalid range!" << endl; // we print that the range is invalid.
+		}
+		else // otherwise,
+		{
+			// we tell our Huffman instance to decode the range, passing in the file paths, offset and length.
+			huffman->DecodeRange(argv[2], argv[3], offset, length);
+		}
+	}
 	else if (command == "t") // If the command is t, we are going to make the tree builder file.
 	{
 		if (argc < 3) // If we have less than 3 arguments, we are missing the input file path,
@@ -0,0 +1,179 @@
+//==============================================================================================
+// File: MemoryBuffer.cpp - Stream buffers over memory implementation
+// c.f.: MemoryBuffer.h
+//
+// These classes let the Huffman class read from and write to memory through the same input
+// and output streams it uses for files, so requests that arrive over a socket can be handled
+// without temporary files or extra copies.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include "MemoryBuffer.h"
+
+MemoryInputBuffer::MemoryInputBuffer(const char* data, size_t size)
+{
+	// The constructor. A stream buffer reads from its get area, so we just point the get
+	// area at the given memory. The get area has to be writable for streams that put
+	// characters back, but we never do that, so casting away the const is safe.
+	//
+	char* begin = const_cast<char*>(data);
+
+	setg(begin, begin, begin + size); // The get area starts at the data, we are at its beginning, and it ends after size bytes.
+}
+
+MemoryInputBuffer::pos_type MemoryInputBuffer::seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode which)
+{
+	// This method moves the read position by the given offset from the beginning, the current
+	// position, or the end of the memory. If the new position is outside of the memory, we
+	// leave the position alone and return -1, just like a file stream would.
+	//
+	off_type position; // The position we are moving to, counting from the beginning of the memory
+
+	if (direction == ios_base::beg) // If we are moving from the beginning,
+	{
+		position = offset; // the offset is the position.
+	}
+	else if (direction == ios_base::cur) // If we are moving from the current position,
+	{
+		position = (gptr() - eback()) + offset; // we add the offset to how far we have read.
+	}
+	else // Otherwise, we are moving from the end,
+	{
+		position = (egptr() - eback()) + offset; // so we add the offset to the size of the memory.
+	}
+
+	if (!(which & ios_base::in) || position < 0 || position > egptr() - eback()) // If the position is invalid,
+	{
+		return pos_type(off_type(-1)); // we say we couldn't move.
+	}
+
+	setg(eback(), eback() + position, egptr()); // Otherwise, we move the read position there,
+
+	return pos_type(position); // and return it.
+}
+
+MemoryInputBuffer::pos_type MemoryInputBuffer::seekpos(pos_type position, ios_base::openmode which)
+{
+	// This method moves the read position to the given position, which is the
+	// same as moving that far from the beginning.
+	//
+	return seekoff(off_type(position), ios_base::beg, which);
+}
+
+StringOutputBuffer::StringOutputBuffer(string& output) : output(output)
+{
+	// The constructor. We start with an empty string and no put area, so
+	// the first character written will make room for itself in overflow.
+	//
+	output.clear();
+
+	written = 0;
+
+	length = 0;
+}
+
+StringOutputBuffer::int_type StringOutputBuffer::overflow(int_type character)
+{
+	// This method gets called when the put area is full. We double the size of the string,
+	// use the new space as the put area, and then write the given character into it.
+	// Resizing the string may move it, so we remember how much we've written and put
+	// the put area back at that spot in the new memory.
+	//
+	written += pptr() - pbase(); // Everything in the put area so far has been written.
+
+	output.resize(output.size() < 4096 ? 4096 : output.size() * 2); // Make room for more, starting off with 4 KB.
+
+	setp(&output[0] + written, &output[0] + output.size()); // The put area is everything after what we've written.
+
+	if (!traits_type::eq_int_type(character, traits_type::eof())) // If we were given a character to write,
+	{
+		*pptr() = traits_type::to_char_type(character); // we put it in the put area,
+
+		pbump(1); // and move past it.
+	}
+
+	return traits_type::not_eof(character); // We return something other than eof to say we succeeded.
+}
+
+void StringOutputBuffer::reserve(size_t size)
+{
+	// This method makes the string big enough to hold the given amount of bytes, so writing
+	// that many bytes never has to grow it. If it's already big enough, we leave it alone.
+	//
+	if (size <= output.size())
+	{
+		return;
+	}
+
+	written += pptr() - pbase(); // Everything in the put area so far has been written,
+
+	output.resize(size); // so we keep it while making the string bigger,
+
+	setp(&output[0] + written, &output[0] + output.size()); // and put the put area after it again.
+}
+
+void StringOutputBuffer::finish()
+{
+	// This method shrinks the string down to the bytes that were actually
+	// written, since overflow makes the string bigger than it needs to be.
+	//
+	written += pptr() - pbase(); // Everything in the put area has been written,
+
+	// so that's how long the string should be, unless we moved back and wrote less than we had before.
+	output.resize(written > length ? written : length);
+
+	setp(nullptr, nullptr); // The put area pointed into the string, so we get rid of it.
+}
+
+StringOutputBuffer::pos_type StringOutputBuffer::seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode which)
+{
+	// This method moves the write position by the given offset from the beginning, the current
+	// position, or the end of what has been written, so something written earlier, like a header,
+	// can be filled in afterwards. We remember how far we had written, so moving back doesn't
+	// lose anything. Moving past the end isn't allowed, since there is nothing there yet.
+	//
+	size_t current = written + (pptr() - pbase()); // The position we are at now
+
+	if (current > length) // If this is the furthest we've written,
+	{
+		length = current; // we remember it.
+	}
+
+	off_type position; // The position we are moving to, counting from the beginning of the string
+
+	if (direction == ios_base::beg) // If we are moving from the beginning,
+	{
+		position = offset; // the offset is the position.
+	}
+	else if (direction == ios_base::cur) // If we are moving from the current position,
+	{
+		position = (off_type)current + offset; // we add the offset to it.
+	}
+	else // Otherwise, we are moving from the end,
+	{
+		position = (off_type)length + offset; // so we add the offset to the furthest we've written.
+	}
+
+	if (!(which & ios_base::out) || position < 0 || position > (off_type)length) // If the position is invalid,
+	{
+		return pos_type(off_type(-1)); // we say we couldn't move.
+	}
+
+	written = (size_t)position; // Otherwise, everything before the position counts as written,
+
+	setp(&output[0] + written, &output[0] + output.size()); // and the put area starts there.
+
+	return pos_type(position);
+}
+
+StringOutputBuffer::pos_type StringOutputBuffer::seekpos(pos_type position, ios_base::openmode which)
+{
+	// This method moves the write position to the given position, which is the
+	// same as moving that far from the beginning.
+	//
+	return seekoff(off_type(position), ios_base::beg, which);
+}
@@ -0,0 +1,42 @@
+//==============================================================================================
+// File: MemoryBuffer.h - Stream buffers over memory
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// A read only stream buffer that reads straight out of memory owned by somebody else,
+// so bytes that are already in memory can be decoded or encoded without copying them.
+class MemoryInputBuffer : public streambuf {
+public:
+	MemoryInputBuffer(const char* data, size_t size); // Makes a stream buffer that reads the given amount of bytes at the given data
+protected:
+	pos_type seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode which) override; // Moves the read position relative to the beginning, current position or end
+	pos_type seekpos(pos_type position, ios_base::openmode which) override; // Moves the read position to the given position
+};
+
+// A stream buffer that writes straight into a string. The string itself is used as the
+// buffer, so once writing is finished the string can be handed off without copying it.
+class StringOutputBuffer : public streambuf {
+public:
+	StringOutputBuffer(string& output); // Makes a stream buffer that writes into the given string, replacing what was in it
+	void reserve(size_t size); // Makes the string big enough to hold the given amount of bytes without growing
+	void finish(); // Shrinks the string down to the bytes that were actually written
+protected:
+	int_type overflow(int_type character) override; // Grows the string when it is full, then writes the given character
+	pos_type seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode which) override; // Moves the write position relative to the beginning, current position or end
+	pos_type seekpos(pos_type position, ios_base::openmode which) override; // Moves the write position to the given position
+private:
+	string& output; // The string we are writing into
+	size_t written; // The amount of bytes written before the current put area, used when the put area is moved
+	size_t length;  // The furthest any write has reached before the write position was last moved back
+};
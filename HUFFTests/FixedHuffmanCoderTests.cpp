@@ -0,0 +1,171 @@
+//==============================================================================================
+// File: FixedHuffmanCoderTests.cpp - FixedHuffmanCoder tests
+//
+// These tests instantiate FixedHuffmanCoder with SampleCodebook.h, which HUFF -g made from
+// SampleCodebook.htree, so the template and the header the -g flag writes are compiled with
+// every build. They check that the coder decodes what it encodes, and that its files and the
+// ones the Huffman class writes with the same tree can be decoded by either one.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include "FixedHuffmanCoder.h"
+#include "Huffman.h"
+#include "SampleCodebook.h"
+#include "TestHarness.h"
+
+typedef FixedHuffmanCoder<SampleCodebook> SampleCoder;
+
+// Writes the tree builder of the sample codebook to a tree file, so the Huffman class can use the same tree.
+static string writeSampleTree()
+{
+	string treePath = TestHarness::TempPath("sample.htree");
+
+	TestHarness::WriteFile(treePath, string((const char*)SampleCodebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE));
+
+	return treePath;
+}
+
+TEST(FixedCoderRoundTrip)
+{
+	string input = TestHarness::MakeText(100000, 1);
+	string encoded;
+	string decoded;
+
+	SampleCoder::EncodeBuffer(input.data(), input.size(), encoded);
+
+	CHECK(encoded.size() < input.size());
+	CHECK(SampleCoder::DecodeBuffer(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded == input);
+}
+
+TEST(FixedCoderRoundTripEmpty)
+{
+	string encoded;
+	string decoded = "leftover";
+
+	SampleCoder::EncodeBuffer("", 0, encoded);
+
+	CHECK(SampleCoder::DecodeBuffer(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded.empty());
+}
+
+TEST(FixedCoderMatchesEncodeFileWithTree)
+{
+	string input = TestHarness::MakeText(50000, 2);
+	string inputPath = TestHarness::TempPath("fixed-match.txt");
+	string outputPath = TestHarness::TempPath("fixed-match.huf");
+
+	TestHarness::WriteFile(inputPath, input);
+
+	Huffman huffman;
+
+	huffman.EncodeFileWithTree(inputPath, writeSampleTree(), outputPath);
+
+	string encoded;
+
+	SampleCoder::EncodeBuffer(input.data(), input.size(), encoded);
+
+	CHECK(TestHarness::ReadFile(outputPath) == encoded);
+}
+
+TEST(FixedCoderStoresLikeEncodeFileWithTree)
+{
+	// Random bytes use every symbol, and the sample tree gives most of them long codes, so both have to store them.
+	string input = TestHarness::MakeRandom(50000, 7);
+	string inputPath = TestHarness::TempPath("fixed-stored.bin");
+	string outputPath = TestHarness::TempPath("fixed-stored.huf");
+
+	TestHarness::WriteFile(inputPath, input);
+
+	Huffman huffman;
+
+	huffman.EncodeFileWithTree(inputPath, writeSampleTree(), outputPath);
+
+	string encoded;
+	string decoded;
+
+	SampleCoder::EncodeBuffer(input.data(), input.size(), encoded);
+
+	HuffmanFormat::header fileHeader;
+
+	CHECK(HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader));
+	CHECK(fileHeader.flags & HuffmanFormat::FLAG_STORED);
+	CHECK(TestHarness::ReadFile(outputPath) == encoded);
+	CHECK(SampleCoder::DecodeBuffer(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded == input);
+}
+
+TEST(FixedCoderFilesDecodeWithDecodeFile)
+{
+	string input = TestHarness::MakeText(50000, 3);
+	string encodedPath = TestHarness::TempPath("fixed-decode.huf");
+	string decodedPath = TestHarness::TempPath("fixed-decode.txt");
+	string encoded;
+
+	SampleCoder::EncodeBuffer(input.data(), input.size(), encoded);
+
+	TestHarness::WriteFile(encodedPath, encoded);
+
+	Huffman huffman;
+
+	huffman.DecodeFile(encodedPath, decodedPath);
+
+	CHECK(TestHarness::ReadFile(decodedPath) == input);
+}
+
+TEST(FixedCoderDecodesIndexedChecksummedFiles)
+{
+	string input = TestHarness::MakeText(50000, 4);
+	string inputPath = TestHarness::TempPath("fixed-options.txt");
+	string outputPath = TestHarness::TempPath("fixed-options.huf");
+
+	TestHarness::WriteFile(inputPath, input);
+
+	Huffman huffman;
+
+	huffman.SetSeekInterval(64);
+	huffman.SetChecksum(true);
+	huffman.EncodeFileWithTree(inputPath, writeSampleTree(), outputPath);
+
+	string encoded = TestHarness::ReadFile(outputPath);
+	string decoded;
+
+	CHECK(SampleCoder::DecodeBuffer(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded == input);
+
+	encoded[encoded.size() / 2] ^= 0x10; // A flipped bit changes the symbols, so the checksum no longer matches.
+
+	CHECK(!SampleCoder::DecodeBuffer(encoded.data(), encoded.size(), decoded));
+}
+
+TEST(FixedCoderRejectsOtherTrees)
+{
+	string input = TestHarness::MakeText(50000, 5);
+	string encoded;
+	string decoded;
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(input.data(), input.size(), encoded); // This builds a tree from the text, which isn't the sample tree.
+
+	CHECK(!SampleCoder::DecodeBuffer(encoded.data(), encoded.size(), decoded));
+}
+
+TEST(FixedCoderRejectsCutOffFiles)
+{
+	string input = TestHarness::MakeText(50000, 6);
+	string encoded;
+	string decoded;
+
+	SampleCoder::EncodeBuffer(input.data(), input.size(), encoded);
+
+	encoded.resize(encoded.size() - 100);
+
+	CHECK(!SampleCoder::DecodeBuffer(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded.size() < input.size());
+	CHECK(input.compare(0, decoded.size(), decoded) == 0);
+}
@@ -0,0 +1,429 @@
+//==============================================================================================
+// File: HuffmanDaemonTests.cpp - HuffmanDaemon tests
+//
+// These tests run the daemon on a thread of its own, connect to its socket the way any other
+// client would, and make sure the responses to the requests we send are what the Huffman
+// class gives for the same payloads, or say why the request failed. The daemon needs Unix
+// domain sockets, so there aren't any tests on Windows.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#ifndef _WIN32
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "HuffmanDaemon.h"
+#include "SampleCodebook.h"
+#include "TestHarness.h"
+
+// A client connected to a daemon's socket, which it disconnects from when it goes away.
+class daemonclient {
+public:
+	daemonclient(const string& socketPath)
+	{
+		// The daemon may not be listening yet, so we keep trying to connect for a few seconds.
+		sockaddr_un address;
+
+		memset(&address, 0, sizeof(address));
+
+		address.sun_family = AF_UNIX;
+
+		strcpy(address.sun_path, socketPath.c_str());
+
+		for (int attempt = 0; attempt < 500 && client < 0; attempt++)
+		{
+			client = socket(AF_UNIX, SOCK_STREAM, 0);
+
+			if (connect(client, (sockaddr*)&address, sizeof(address)) < 0)
+			{
+				close(client);
+
+				client = -1;
+
+				this_thread::sleep_for(chrono::milliseconds(10));
+			}
+		}
+	}
+
+	~daemonclient()
+	{
+		if (client >= 0)
+		{
+			close(client);
+		}
+	}
+
+	// Sends a request with the given operation and payload, and receives the response, returning false if either fails.
+	bool Request(unsigned char operation, const string& payload, unsigned char& status, string& response)
+	{
+		string frame(4, '\0');
+
+		unsigned int length = (unsigned int)payload.size() + 1;
+
+		for (int i = 0; i < 4; i++)
+		{
+			frame[i] = (char)(length >> (8 * i));
+		}
+
+		frame += (char)operation;
+		frame += payload;
+
+		if (client < 0 || !sendAll(frame))
+		{
+			return false;
+		}
+
+		unsigned char lengthBytes[4];
+
+		if (!receiveAll((char*)lengthBytes, sizeof(lengthBytes)))
+		{
+			return false;
+		}
+
+		length = lengthBytes[0] | lengthBytes[1] << 8 | lengthBytes[2] << 16 | (unsigned int)lengthBytes[3] << 24;
+
+		if (length == 0)
+		{
+			return false;
+		}
+
+		string body(length, '\0');
+
+		if (!receiveAll(&body[0], length))
+		{
+			return false;
+		}
+
+		status = (unsigned char)body[0];
+		response = body.substr(1);
+
+		return true;
+	}
+private:
+	int client = -1;	// Our connection to the daemon, or -1 if we couldn't connect
+
+	bool sendAll(const string& bytes)
+	{
+		for (size_t sent = 0; sent < bytes.size();)
+		{
+			ssize_t count = send(client, bytes.data() + sent, bytes.size() - sent, 0);
+
+			if (count <= 0)
+			{
+				return false;
+			}
+
+			sent += count;
+		}
+
+		return true;
+	}
+
+	bool receiveAll(char* buffer, size_t size)
+	{
+		for (size_t received = 0; received < size;)
+		{
+			ssize_t count = recv(client, buffer + received, size - received, 0);
+
+			if (count <= 0)
+			{
+				return false;
+			}
+
+			received += count;
+		}
+
+		return true;
+	}
+};
+
+// A daemon running on its own thread, along with a client connected to it. It stops the
+// daemon when it goes away, so a test that stops early doesn't leave it running.
+class runningdaemon {
+public:
+	runningdaemon(HuffmanDaemon& daemon, const string& socketPath) : daemon(daemon), runner([&daemon] { daemon.Run(); }), client(socketPath)
+	{
+	}
+
+	~runningdaemon()
+	{
+		daemon.Stop();
+
+		runner.join();
+	}
+
+	// Sends a request from our client, just like daemonclient::Request.
+	bool Request(unsigned char operation, const string& payload, unsigned char& status, string& response)
+	{
+		return client.Request(operation, payload, status, response);
+	}
+private:
+	HuffmanDaemon& daemon;	// The daemon we run
+	thread runner;			// The thread running it
+	daemonclient client;	// Our connection to it, made once it is listening
+};
+
+TEST(DaemonRoundTrip)
+{
+	string input = TestHarness::MakeText(100000, 50);
+	string expected;
+	string encoded;
+	string decoded;
+	unsigned char status;
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(input.data(), input.size(), expected);
+
+	HuffmanDaemon daemon(TestHarness::TempPath("round-trip.sock"), 2);
+
+	runningdaemon running(daemon, TestHarness::TempPath("round-trip.sock"));
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE, input, status, encoded) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(encoded == expected);
+
+	for (int i = 0; i < 3; i++) // Decoding again uses the instance that already has the tree built.
+	{
+		CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, encoded, status, decoded) && status == HuffmanDaemon::STATUS_OK);
+		CHECK(decoded == input);
+	}
+}
+
+TEST(DaemonSendsBackWhyDecodingFailed)
+{
+	string text = TestHarness::MakeText(100000, 51);
+	string random = TestHarness::MakeRandom(10000, 52);
+	string codedFile;
+	string storedFile;
+	string response;
+	unsigned char status;
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(text.data(), text.size(), codedFile);
+	huffman.EncodeBuffer(random.data(), random.size(), storedFile);
+
+	HuffmanDaemon daemon(TestHarness::TempPath("errors.sock"), 1);
+
+	runningdaemon running(daemon, TestHarness::TempPath("errors.sock"));
+
+	// A coded file goes to an instance with its tree built, and a stored file to the scratch instance, and both have to say why they failed.
+	CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, codedFile.substr(0, codedFile.size() / 2), status, response));
+	CHECK(status == HuffmanDaemon::STATUS_ERROR && response == "The input file is truncated.");
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, storedFile.substr(0, storedFile.size() / 2), status, response));
+	CHECK(status == HuffmanDaemon::STATUS_ERROR && response == "The input file is truncated.");
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, codedFile, status, response)); // The same instance still decodes a good file.
+	CHECK(status == HuffmanDaemon::STATUS_OK && response == text);
+}
+
+TEST(DaemonUsesTheGivenSettings)
+{
+	string directory = TestHarness::MakeTempDirectory("daemon-cache");
+	string input = TestHarness::MakeText(100000, 53);
+	string expected;
+	string encoded;
+	string decoded;
+	unsigned char status;
+
+	Huffman settings; // The options given to the program end up on an instance like this one.
+
+	settings.SetTableCache(directory);
+	settings.SetSeekInterval(64);
+	settings.SetChecksum(true);
+	settings.SetVerify(true);
+
+	Huffman huffman;
+
+	huffman.CopySettings(settings);
+	huffman.EncodeBuffer(input.data(), input.size(), expected);
+
+	HuffmanFormat::header fileHeader;
+
+	CHECK(HuffmanFormat::readHeader(expected.data(), expected.size(), fileHeader));
+	CHECK((fileHeader.flags & HuffmanFormat::FLAG_CHECKSUM) && (fileHeader.flags & HuffmanFormat::FLAG_SEEK_TABLE));
+
+	HuffmanDaemon daemon(TestHarness::TempPath("settings.sock"), 2);
+
+	daemon.SetSettings(&settings);
+
+	runningdaemon running(daemon, TestHarness::TempPath("settings.sock"));
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE, input, status, encoded) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(encoded == expected); // The file has the seek table and checksum,
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, encoded, status, decoded) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(decoded == input);
+	CHECK(!filesystem::is_empty(directory)); // and decoding it put its tables in the cache.
+}
+
+TEST(DaemonRoundTripBlocks)
+{
+	string directory = TestHarness::MakeTempDirectory("daemon-trees");
+	string input = TestHarness::MakeText(200000, 54) + TestHarness::MakeRandom(50000, 55) + TestHarness::MakeText(200000, 56);
+	string treeBuilder((const char*)SampleCodebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE);
+	string plainFile;
+	string blockFile;
+	string treeFile;
+	string response;
+	unsigned char status;
+
+	TestHarness::WriteFile(directory + "/sample.htree", treeBuilder);
+
+	Huffman plain;
+
+	plain.EncodeBuffer(input.data(), input.size(), plainFile);
+
+	Huffman settings;
+
+	settings.SetBlockSize(Huffman::MIN_BLOCK_SIZE * 4);
+
+	Huffman huffman;
+
+	huffman.CopySettings(settings);
+	huffman.EncodeBuffer(input.data(), input.size(), blockFile);
+	huffman.EncodeBufferWithTree(input.data(), input.size(), treeBuilder, treeFile);
+
+	HuffmanFormat::header blockHeader;
+	HuffmanFormat::header treeHeader;
+
+	CHECK(HuffmanFormat::readHeader(blockFile.data(), blockFile.size(), blockHeader) && (blockHeader.flags & HuffmanFormat::FLAG_BLOCKS));
+	CHECK(HuffmanFormat::readHeader(treeFile.data(), treeFile.size(), treeHeader) && (treeHeader.flags & HuffmanFormat::FLAG_BLOCKS));
+
+	HuffmanDaemon daemon(TestHarness::TempPath("blocks.sock"), 1); // With one worker, every request shares the same instances.
+
+	daemon.SetSettings(&settings);
+	daemon.SetTreeDirectory(directory);
+
+	runningdaemon running(daemon, TestHarness::TempPath("blocks.sock"));
+
+	// Block files switch trees as they go, so they mustn't leave an instance kept for one tree with another built. We mix them
+	// with a file coded with a single tree, and ask for each twice, so every file is decoded after the others.
+	for (int i = 0; i < 2; i++)
+	{
+		CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, blockFile, status, response) && status == HuffmanDaemon::STATUS_OK);
+		CHECK(response == input);
+
+		CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, plainFile, status, response) && status == HuffmanDaemon::STATUS_OK);
+		CHECK(response == input);
+
+		CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE, input, status, response) && status == HuffmanDaemon::STATUS_OK);
+		CHECK(response == blockFile);
+
+		string name = "sample.htree";
+		string payload = string(1, (char)name.size()) + '\0' + name + input;
+
+		CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE_WITH_TREE, payload, status, response) && status == HuffmanDaemon::STATUS_OK);
+		CHECK(response == treeFile);
+
+		CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, treeFile, status, response) && status == HuffmanDaemon::STATUS_OK);
+		CHECK(response == input);
+	}
+}
+
+TEST(DaemonDoesNotTieWorkersToIdleClients)
+{
+	string input = TestHarness::MakeText(50000, 57);
+	string response;
+	unsigned char status;
+
+	HuffmanDaemon daemon(TestHarness::TempPath("idle.sock"), 1);
+
+	runningdaemon running(daemon, TestHarness::TempPath("idle.sock"));
+
+	daemonclient idle(TestHarness::TempPath("idle.sock")); // A client that is connected, but hasn't asked for anything yet,
+	daemonclient other(TestHarness::TempPath("idle.sock"));
+
+	// mustn't keep the only worker from the others. Each of them gets their turn between requests.
+	CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE, input, status, response) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(other.Request(HuffmanDaemon::REQUEST_DECODE, response, status, response) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(response == input);
+	CHECK(idle.Request(HuffmanDaemon::REQUEST_ENCODE, input, status, response) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, response, status, response) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(response == input);
+}
+
+TEST(DaemonRefusesResponsesOverTheLimit)
+{
+	string input = TestHarness::MakeText(50000, 58);
+	string encoded;
+	string response;
+	unsigned char status;
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	HuffmanDaemon daemon(TestHarness::TempPath("limit.sock"), 1);
+
+	daemon.SetMaxOutputSize(input.size() - 1); // Encoding fits, but decoding doesn't.
+
+	runningdaemon running(daemon, TestHarness::TempPath("limit.sock"));
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE, input, status, response) && status == HuffmanDaemon::STATUS_OK);
+	CHECK(response == encoded);
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_DECODE, encoded, status, response)); // The header says how big the output is, so it isn't even decoded.
+	CHECK(status == HuffmanDaemon::STATUS_ERROR && response == "The output would be larger than the output limit.");
+
+	string random = TestHarness::MakeRandom(input.size(), 59); // Stored input comes out a little bigger than it went in.
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE, random, status, response));
+	CHECK(status == HuffmanDaemon::STATUS_ERROR && response == "The output is larger than the output limit.");
+}
+
+TEST(DaemonOnlyReadsTreeFilesFromTheTreeDirectory)
+{
+	string directory = TestHarness::MakeTempDirectory("daemon-only-trees");
+	string input = TestHarness::MakeText(50000, 60);
+	string treeBuilder((const char*)SampleCodebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE);
+	string expected;
+	string response;
+	unsigned char status;
+
+	TestHarness::WriteFile(directory + "/sample.htree", treeBuilder);
+	TestHarness::WriteFile(TestHarness::TempPath("outside.htree"), treeBuilder); // A tree file right next to the directory
+
+	Huffman huffman;
+
+	huffman.EncodeBufferWithTree(input.data(), input.size(), treeBuilder, expected);
+
+	HuffmanDaemon withoutTrees(TestHarness::TempPath("no-trees.sock"), 1);
+
+	{
+		runningdaemon running(withoutTrees, TestHarness::TempPath("no-trees.sock"));
+
+		CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE_WITH_TREE, string("\x0c\0sample.htree", 14) + input, status, response));
+		CHECK(status == HuffmanDaemon::STATUS_ERROR && response == "Unable to open tree file."); // Without a directory, nothing is read.
+	}
+
+	HuffmanDaemon withTrees(TestHarness::TempPath("trees.sock"), 1);
+
+	withTrees.SetTreeDirectory(directory);
+
+	runningdaemon running(withTrees, TestHarness::TempPath("trees.sock"));
+
+	CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE_WITH_TREE, string("\x0c\0sample.htree", 14) + input, status, response));
+	CHECK(status == HuffmanDaemon::STATUS_OK && response == expected);
+
+	const string names[] = { "../outside.htree", string("sample.htree\0x", 14), ".", "", "missing.htree" };
+
+	for (const string& name : names)
+	{
+		string payload = string(1, (char)name.size()) + '\0' + name + input;
+
+		CHECK(running.Request(HuffmanDaemon::REQUEST_ENCODE_WITH_TREE, payload, status, response));
+		CHECK(status == HuffmanDaemon::STATUS_ERROR && response == "Unable to open tree file.");
+	}
+}
+#endif
@@ -0,0 +1,153 @@
+//==============================================================================================
+// File: HuffmanStreamDecoderTests.cpp - HuffmanStreamDecoder tests
+//
+// These tests feed encoded files to the streaming decoder a small piece at a time, so codes,
+// headers and tables are split across pieces, and make sure what it drains is the original
+// file, or that it fails if the file is corrupt.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <algorithm>
+
+#include "HuffmanStreamDecoder.h"
+#include "TestHarness.h"
+
+// Decodes the given file 1000 bytes at a time into the given output, returning whether it decoded all of it.
+static bool streamDecode(const string& encoded, string& output)
+{
+	HuffmanStreamDecoder decoder;
+
+	char buffer[777]; // Smaller than the pieces we feed, so draining has to stop partway through them.
+
+	output.clear();
+
+	for (size_t start = 0; start < encoded.size(); start += 1000)
+	{
+		decoder.Feed(encoded.data() + start, min((size_t)1000, encoded.size() - start));
+
+		size_t count;
+
+		while ((count = decoder.Drain(buffer, sizeof(buffer))) > 0)
+		{
+			output.append(buffer, count);
+		}
+	}
+
+	decoder.Finish();
+
+	size_t count;
+
+	while ((count = decoder.Drain(buffer, sizeof(buffer))) > 0)
+	{
+		output.append(buffer, count);
+	}
+
+	return decoder.IsDone() && !decoder.HasFailed();
+}
+
+TEST(StreamDecoderRoundTripIndexed)
+{
+	string input = TestHarness::MakeText(100000, 20);
+	string encoded;
+	string decoded;
+
+	Huffman huffman;
+
+	huffman.SetSeekInterval(64);
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	CHECK(streamDecode(encoded, decoded));
+	CHECK(decoded == input);
+}
+
+TEST(StreamDecoderRejectsOversizedSeekTables)
+{
+	string input = TestHarness::MakeText(20000, 21);
+	string encoded;
+	string decoded;
+
+	Huffman huffman;
+
+	huffman.SetSeekInterval(64);
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	// Files with the original length are done after the last symbol, so the decoder never needs their seek
+	// table. Version 2 files don't have the length, so it has to find where the table starts from its footer.
+	// We turn the file into one by dropping the length after the flags.
+	encoded[4] = 2;
+	encoded.erase(HuffmanFormat::HEADER_SIZE, HuffmanFormat::LENGTH_SIZE);
+
+	CHECK(streamDecode(encoded, decoded));
+	CHECK(decoded.compare(0, input.size(), input) == 0); // Without the length, the padding bits can decode to a few more symbols.
+
+	// Counts whose table size overflows to 0 and 16 bytes, the largest count there is, and one more than the whole file could hold.
+	const unsigned long long counts[] = { 1ULL << 60, (1ULL << 60) + 1, ~0ULL, encoded.size() / HuffmanFormat::SEEK_ENTRY_SIZE + 1 };
+
+	for (unsigned long long count : counts)
+	{
+		string corrupt = encoded;
+
+		for (int i = 0; i < 8; i++) // The count is the last 8 bytes of the file.
+		{
+			corrupt[corrupt.size() - 8 + i] = (char)(count >> (8 * i));
+		}
+
+		CHECK(!streamDecode(corrupt, decoded));
+	}
+}
+
+TEST(StreamDecoderChecksChecksums)
+{
+	// Text is coded and random bytes are stored, and both have to be checked against their checksum.
+	string inputs[] = { TestHarness::MakeText(100000, 22), TestHarness::MakeRandom(100000, 23) };
+
+	for (const string& input : inputs)
+	{
+		string encoded;
+		string decoded;
+
+		Huffman huffman;
+
+		huffman.SetChecksum(true);
+		huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+		HuffmanFormat::header fileHeader;
+
+		CHECK(HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader) && (fileHeader.flags & HuffmanFormat::FLAG_CHECKSUM));
+		CHECK(streamDecode(encoded, decoded) && decoded == input);
+
+		// A flipped bit near the end still decodes to something, just not the input, and so does a changed checksum.
+		size_t positions[] = { encoded.size() - 100, (size_t)HuffmanFormat::headerSize(fileHeader) - 1 };
+
+		for (size_t position : positions)
+		{
+			string corrupt = encoded;
+
+			corrupt[position] ^= 0x10;
+
+			CHECK(!streamDecode(corrupt, decoded));
+			CHECK(!huffman.DecodeBuffer(corrupt.data(), corrupt.size(), decoded));
+			CHECK(huffman.GetError() == "The input file is corrupt.");
+		}
+	}
+}
+
+TEST(StreamDecoderRoundTripBlocks)
+{
+	string input = TestHarness::MakeText(300000, 24) + TestHarness::MakeRandom(100000, 25) + TestHarness::MakeText(300000, 26);
+	string encoded;
+	string decoded;
+
+	Huffman huffman;
+
+	huffman.SetBlockSize(Huffman::MIN_BLOCK_SIZE * 4);
+	huffman.SetChecksum(true);
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	CHECK(streamDecode(encoded, decoded));
+	CHECK(decoded == input);
+}
@@ -0,0 +1,252 @@
+//==============================================================================================
+// File: HuffmanTableCacheTests.cpp - HuffmanTableCache tests
+//
+// These tests decode with a table cache, and plant cache files that don't match their tree,
+// or that describe a tree no tree builder file could, to make sure a file decodes the same
+// way whether the cache has tables for its tree or not.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+#include "Huffman.h"
+#include "HuffmanTableCache.h"
+#include "TestHarness.h"
+
+// Builds the tables of the tree the given tree builder bytes combine, without checking that they describe a tree
+// the way Huffman does, so we can make tables that look right for bytes Huffman would refuse. Internal nodes are
+// numbered in the order they are reached from the root, left first, the same way Huffman numbers them.
+static HuffmanTables makeTables(const string& treeBuilder)
+{
+	HuffmanTables tables;
+
+	memset(&tables, 0, sizeof(tables));
+	memcpy(tables.magic, HuffmanTableCache::MAGIC, sizeof(tables.magic));
+
+	tables.byteOrder = HuffmanTableCache::BYTE_ORDER_MARK;
+	tables.version = HuffmanTableCache::VERSION;
+
+	memcpy(tables.treeBuilder, treeBuilder.data(), HuffmanFormat::TREE_BUILDER_SIZE);
+
+	// Every node is a leaf below 256 or an internal node at 256 plus its combination, whose children are in these arrays.
+	unsigned short slots[256]; // The node in each slot
+	unsigned short left[255];
+	unsigned short right[255];
+
+	for (int i = 0; i < 256; i++)
+	{
+		slots[i] = i;
+	}
+
+	for (int i = 0; i < 255; i++)
+	{
+		unsigned char leftSlot = treeBuilder[2 * i];
+		unsigned char rightSlot = treeBuilder[2 * i + 1];
+
+		left[i] = slots[leftSlot];
+		right[i] = slots[rightSlot];
+
+		slots[leftSlot] = 256 + i;
+	}
+
+	// We walk down from the root, which is the last combination, giving each internal node the next row and each leaf its code.
+	struct step {
+		unsigned short node;
+		unsigned short* parentEntry;	// Where the number of the node goes in its parent's row
+		unsigned char code[HuffmanTables::CODE_BYTES];
+		unsigned int length;
+	};
+
+	vector<step> pending = { { 256 + 254, nullptr, {}, 0 } };
+
+	unsigned short nextRow = 0;
+
+	while (!pending.empty())
+	{
+		step current = pending.back();
+
+		pending.pop_back();
+
+		if (current.node < 256) // A leaf is numbered by its symbol, and gets the code of the path to it.
+		{
+			*current.parentEntry = HuffmanTables::LEAF + current.node;
+
+			tables.lengths[current.node] = (unsigned char)current.length;
+
+			memcpy(tables.codes[current.node], current.code, HuffmanTables::CODE_BYTES);
+
+			continue;
+		}
+
+		unsigned short row = nextRow++;
+
+		if (current.parentEntry != nullptr)
+		{
+			*current.parentEntry = row;
+		}
+
+		step rightStep = { right[current.node - 256], &tables.children[row][1], {}, current.length + 1 };
+		step leftStep = { left[current.node - 256], &tables.children[row][0], {}, current.length + 1 };
+
+		memcpy(rightStep.code, current.code, HuffmanTables::CODE_BYTES);
+		memcpy(leftStep.code, current.code, HuffmanTables::CODE_BYTES);
+
+		rightStep.code[current.length / 8] |= 128 >> (current.length % 8);
+
+		pending.push_back(rightStep); // The left child is taken off first, so it is numbered first.
+		pending.push_back(leftStep);
+	}
+
+	return tables;
+}
+
+// Returns the given input encoded with a tree built from it, and the bytes of its tree builder.
+static string encodeText(const string& input, string& treeBuilder)
+{
+	Huffman huffman;
+
+	string encoded;
+
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	treeBuilder = huffman.GetTreeBuilder();
+
+	return encoded;
+}
+
+// Returns the path of the only cache file in the given directory, or an empty string if there isn't exactly one.
+static string onlyCacheFile(const string& directory)
+{
+	string path;
+	int count = 0;
+
+	for (const auto& entry : filesystem::directory_iterator(directory))
+	{
+		path = entry.path().string();
+
+		count++;
+	}
+
+	return count == 1 ? path : "";
+}
+
+TEST(TableCacheRoundTrip)
+{
+	string directory = TestHarness::MakeTempDirectory("cache-round-trip");
+	string input = TestHarness::MakeText(50000, 40);
+	string treeBuilder;
+	string encoded = encodeText(input, treeBuilder);
+	string decoded;
+
+	Huffman first;
+
+	first.SetTableCache(directory);
+
+	CHECK(first.DecodeBuffer(encoded.data(), encoded.size(), decoded) && decoded == input);
+	CHECK(!onlyCacheFile(directory).empty()); // Building the tree stored its tables.
+
+	Huffman second; // A new instance finds the tables in the cache instead of building them.
+
+	second.SetTableCache(directory);
+
+	CHECK(second.DecodeBuffer(encoded.data(), encoded.size(), decoded) && decoded == input);
+}
+
+TEST(MakeTablesMatchesHuffman)
+{
+	string treeBuilder;
+
+	encodeText(TestHarness::MakeText(50000, 41), treeBuilder);
+
+	Huffman huffman;
+
+	const HuffmanTables* built = huffman.GetTables(treeBuilder);
+
+	HuffmanTables made = makeTables(treeBuilder);
+
+	CHECK(built != nullptr);
+	CHECK(memcmp(built, &made, sizeof(HuffmanTables)) == 0);
+}
+
+TEST(TableCacheRejectsDamagedFiles)
+{
+	string directory = TestHarness::MakeTempDirectory("cache-damaged");
+	string input = TestHarness::MakeText(50000, 42);
+	string treeBuilder;
+	string encoded = encodeText(input, treeBuilder);
+	string reencoded;
+	string decoded;
+
+	Huffman withoutCache; // Encoding with the tree file gives us what the codes should encode the input to.
+
+	CHECK(withoutCache.EncodeBufferWithTree(input.data(), input.size(), treeBuilder, reencoded));
+
+	// The first bit of a code, a child in the decoding tree, and the length of a code. Each of them
+	// would still encode or decode something, just not what the tree does.
+	const size_t offsets[] = { offsetof(HuffmanTables, codes) + 'e' * HuffmanTables::CODE_BYTES, offsetof(HuffmanTables, children) + 2, offsetof(HuffmanTables, lengths) + 't' };
+	const unsigned char bits[] = { 0x80, 0x01, 0x01 };
+
+	for (int i = 0; i < 3; i++)
+	{
+		HuffmanTables tables = makeTables(treeBuilder);
+
+		((unsigned char*)&tables)[offsets[i]] ^= bits[i];
+
+		TestHarness::MakeTempDirectory("cache-damaged");
+
+		HuffmanTableCache(directory).Store(tables);
+
+		string output;
+
+		Huffman withCache;
+
+		withCache.SetTableCache(directory);
+
+		CHECK(withCache.DecodeBuffer(encoded.data(), encoded.size(), decoded) && decoded == input);
+		CHECK(withCache.EncodeBufferWithTree(input.data(), input.size(), treeBuilder, output) && output == reencoded);
+	}
+}
+
+TEST(TableCacheDoesNotAcceptInvalidTreeBuilders)
+{
+	string directory = TestHarness::MakeTempDirectory("cache-invalid");
+	string input = TestHarness::MakeText(50000, 43);
+	string treeBuilder;
+	string encoded = encodeText(input, treeBuilder);
+	string decoded;
+
+	HuffmanFormat::header fileHeader;
+
+	HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader);
+
+	size_t treeBuilderStart = HuffmanFormat::headerSize(fileHeader);
+
+	// Swapping the last pair puts the root in the higher slot. That still combines two nodes, so the tables for it
+	// are consistent, but no tree builder lists the higher slot first, so Huffman refuses to build the tree.
+	string swapped = treeBuilder;
+
+	swap(swapped[508], swapped[509]);
+
+	encoded.replace(treeBuilderStart, HuffmanFormat::TREE_BUILDER_SIZE, swapped);
+
+	Huffman withoutCache;
+
+	CHECK(!withoutCache.DecodeBuffer(encoded.data(), encoded.size(), decoded));
+
+	HuffmanTableCache(directory).Store(makeTables(swapped)); // With tables for the swapped bytes in the cache,
+
+	CHECK(!onlyCacheFile(directory).empty());
+
+	Huffman withCache;
+
+	withCache.SetTableCache(directory);
+
+	CHECK(!withCache.DecodeBuffer(encoded.data(), encoded.size(), decoded)); // it has to be refused all the same.
+	CHECK(withCache.GetTables(swapped) == nullptr);
+}
@@ -0,0 +1,453 @@
+//==============================================================================================
+// File: HuffmanTests.cpp - Huffman tests
+//
+// These tests encode and decode buffers and files with the Huffman class, with and without
+// its options, and make sure files that were cut off or corrupted are rejected instead of
+// decoding into something that isn't the original.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <iostream>
+#include <sstream>
+
+#include "FixedHuffmanCoder.h"
+#include "Huffman.h"
+#include "SampleCodebook.h"
+#include "TestHarness.h"
+
+// Returns entry counts that don't fit the given coded file. The first two are so large that multiplying them by the
+// entry size overflows, to 0 and to 16 bytes, and the last is one entry more than fits after the tree builder.
+static unsigned long long badEntryCounts(const string& encoded, int index)
+{
+	HuffmanFormat::header fileHeader;
+
+	HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader);
+
+	size_t dataStart = HuffmanFormat::headerSize(fileHeader) + HuffmanFormat::TREE_BUILDER_SIZE;
+
+	unsigned long long fits = (encoded.size() - dataStart - HuffmanFormat::SEEK_FOOTER_SIZE) / HuffmanFormat::SEEK_ENTRY_SIZE;
+
+	const unsigned long long counts[] = { 1ULL << 60, (1ULL << 60) + 1, ~0ULL, fits + 1 };
+
+	return counts[index];
+}
+
+const int BAD_ENTRY_COUNTS = 4;
+
+// Returns the given file with the entry count in its seek table footer replaced by the given one.
+static string withEntryCount(string encoded, unsigned long long entryCount)
+{
+	for (int i = 0; i < 8; i++) // The count is the last 8 bytes of the file, least significant byte first.
+	{
+		encoded[encoded.size() - 8 + i] = (char)(entryCount >> (8 * i));
+	}
+
+	return encoded;
+}
+
+// Returns the given input encoded with a seek table.
+static string encodeIndexed(const string& input)
+{
+	Huffman huffman;
+
+	huffman.SetSeekInterval(64);
+
+	string encoded;
+
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	return encoded;
+}
+
+TEST(DecodeRangeRoundTrip)
+{
+	string input = TestHarness::MakeText(200000, 10);
+	string inputPath = TestHarness::TempPath("range.txt");
+	string encodedPath = TestHarness::TempPath("range.huf");
+	string rangePath = TestHarness::TempPath("range.out");
+
+	TestHarness::WriteFile(inputPath, input);
+
+	Huffman encoder;
+
+	encoder.SetSeekInterval(1000);
+	encoder.EncodeFile(inputPath, encodedPath);
+
+	Huffman decoder;
+
+	decoder.DecodeRange(encodedPath, rangePath, 123457, 5000);
+
+	CHECK(TestHarness::ReadFile(rangePath) == input.substr(123457, 5000));
+
+	decoder.DecodeRange(encodedPath, rangePath, 199000, 5000); // A range past the end stops at the end.
+
+	CHECK(TestHarness::ReadFile(rangePath) == input.substr(199000));
+}
+
+TEST(DecodeBufferRejectsOversizedSeekTables)
+{
+	string input = TestHarness::MakeText(20000, 11);
+	string encoded = encodeIndexed(input);
+	string decoded;
+
+	Huffman huffman;
+
+	CHECK(huffman.DecodeBuffer(encoded.data(), encoded.size(), decoded) && decoded == input);
+
+	for (int i = 0; i < BAD_ENTRY_COUNTS; i++)
+	{
+		string corrupt = withEntryCount(encoded, badEntryCounts(encoded, i));
+
+		CHECK(!huffman.DecodeBuffer(corrupt.data(), corrupt.size(), decoded));
+	}
+}
+
+TEST(DecodeFileRejectsOversizedSeekTables)
+{
+	string input = TestHarness::MakeText(20000, 12);
+	string encoded = encodeIndexed(input);
+	string encodedPath = TestHarness::TempPath("seek-bad.huf");
+	string decodedPath = TestHarness::TempPath("seek-bad.txt");
+
+	Huffman huffman;
+
+	for (int i = 0; i < BAD_ENTRY_COUNTS; i++)
+	{
+		TestHarness::WriteFile(encodedPath, withEntryCount(encoded, badEntryCounts(encoded, i)));
+
+		huffman.DecodeFile(encodedPath, decodedPath);
+
+		CHECK(TestHarness::ReadFile(decodedPath).empty()); // The table is checked before anything is decoded.
+
+		huffman.DecodeRange(encodedPath, decodedPath, 100, 100);
+
+		CHECK(TestHarness::ReadFile(decodedPath).empty());
+	}
+}
+
+TEST(FixedCoderRejectsOversizedSeekTables)
+{
+	string input = TestHarness::MakeText(20000, 13);
+	string inputPath = TestHarness::TempPath("seek-fixed.txt");
+	string treePath = TestHarness::TempPath("seek-fixed.htree");
+	string encodedPath = TestHarness::TempPath("seek-fixed.huf");
+
+	TestHarness::WriteFile(inputPath, input);
+	TestHarness::WriteFile(treePath, string((const char*)SampleCodebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE));
+
+	Huffman huffman;
+
+	huffman.SetSeekInterval(64);
+	huffman.EncodeFileWithTree(inputPath, treePath, encodedPath);
+
+	string encoded = TestHarness::ReadFile(encodedPath);
+	string decoded;
+
+	CHECK(FixedHuffmanCoder<SampleCodebook>::DecodeBuffer(encoded.data(), encoded.size(), decoded) && decoded == input);
+
+	for (int i = 0; i < BAD_ENTRY_COUNTS; i++)
+	{
+		string corrupt = withEntryCount(encoded, badEntryCounts(encoded, i));
+
+		CHECK(!FixedHuffmanCoder<SampleCodebook>::DecodeBuffer(corrupt.data(), corrupt.size(), decoded));
+	}
+}
+
+// Encodes the given input to a file with the given Huffman instance, cuts the file down to the given fraction of its
+// size, and decodes it, returning what was decoded. The output is made as big as the original before decoding starts.
+static string decodeCutOffFile(Huffman& encoder, const string& input, const string& name, double fraction)
+{
+	string inputPath = TestHarness::TempPath(name + ".txt");
+	string encodedPath = TestHarness::TempPath(name + ".huf");
+	string decodedPath = TestHarness::TempPath(name + ".out");
+
+	TestHarness::WriteFile(inputPath, input);
+
+	encoder.EncodeFile(inputPath, encodedPath);
+
+	string encoded = TestHarness::ReadFile(encodedPath);
+
+	TestHarness::WriteFile(encodedPath, encoded.substr(0, (size_t)(encoded.size() * fraction)));
+
+	Huffman decoder;
+
+	decoder.DecodeFile(encodedPath, decodedPath);
+
+	return TestHarness::ReadFile(decodedPath);
+}
+
+TEST(DecodeFileCutsOffOutputOfCutOffFiles)
+{
+	string input = TestHarness::MakeText(300000, 30);
+
+	Huffman encoder;
+
+	string decoded = decodeCutOffFile(encoder, input, "cut", 0.5);
+
+	CHECK(!decoded.empty());
+	CHECK(decoded.size() < input.size() * 3 / 4); // Half of the encoded bits can't decode to much more than half of the input.
+	CHECK(input.compare(0, decoded.size(), decoded) == 0);
+}
+
+TEST(DecodeFileCutsOffOutputOfCutOffBlockFiles)
+{
+	// Text with random bytes in the middle, so some blocks are coded and some are stored.
+	string input = TestHarness::MakeText(300000, 31) + TestHarness::MakeRandom(100000, 32) + TestHarness::MakeText(300000, 33);
+
+	Huffman encoder;
+
+	encoder.SetBlockSize(Huffman::MIN_BLOCK_SIZE * 4);
+	encoder.SetChecksum(true);
+
+	string decoded = decodeCutOffFile(encoder, input, "cut-blocks", 0.5);
+
+	CHECK(!decoded.empty());
+	CHECK(decoded.size() < input.size());
+	CHECK(input.compare(0, decoded.size(), decoded) == 0);
+}
+
+TEST(DecodeFileCutsOffOutputOfCutOffStoredFiles)
+{
+	string input = TestHarness::MakeRandom(100000, 34);
+
+	Huffman encoder;
+
+	string decoded = decodeCutOffFile(encoder, input, "cut-stored", 0.5);
+
+	CHECK(!decoded.empty());
+	CHECK(decoded.size() < input.size());
+	CHECK(input.compare(0, decoded.size(), decoded) == 0);
+}
+
+TEST(DecodeBufferKeepsErrorsInsteadOfPrintingThem)
+{
+	string input = TestHarness::MakeText(20000, 35);
+	string encoded = encodeIndexed(input);
+	string unindexed;
+	string decoded;
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(input.data(), input.size(), unindexed);
+
+	string cutOff = unindexed.substr(0, unindexed.size() / 2);
+	string corrupt = withEntryCount(encoded, badEntryCounts(encoded, 0));
+
+	stringstream printed; // Whatever the instance prints, which should be nothing when the output is memory.
+
+	streambuf* previous = cout.rdbuf(printed.rdbuf());
+
+	bool cutOffDecoded = huffman.DecodeBuffer(cutOff.data(), cutOff.size(), decoded);
+	string cutOffError = huffman.GetError();
+	bool corruptDecoded = huffman.DecodeBuffer(corrupt.data(), corrupt.size(), decoded);
+	string corruptError = huffman.GetError();
+	bool decodedAfter = huffman.DecodeBuffer(encoded.data(), encoded.size(), decoded);
+	string errorAfter = huffman.GetError();
+
+	cout.rdbuf(previous);
+
+	CHECK(!cutOffDecoded && cutOffError == "The input file is truncated.");
+	CHECK(!corruptDecoded && corruptError == "The input file has an invalid seek table.");
+	CHECK(decodedAfter && errorAfter.empty() && decoded == input); // Succeeding clears the error of the last operation.
+	CHECK(printed.str().find("The input file") == string::npos);
+}
+
+TEST(DecodeFileStillPrintsErrors)
+{
+	string input = TestHarness::MakeText(20000, 36);
+	string encoded;
+	string encodedPath = TestHarness::TempPath("printed.huf");
+	string decodedPath = TestHarness::TempPath("printed.txt");
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	TestHarness::WriteFile(encodedPath, encoded.substr(0, encoded.size() / 2));
+
+	stringstream printed;
+
+	streambuf* previous = cout.rdbuf(printed.rdbuf());
+
+	huffman.DecodeFile(encodedPath, decodedPath);
+
+	cout.rdbuf(previous);
+
+	CHECK(huffman.GetError() == "The input file is truncated.");
+	CHECK(printed.str().find("The input file is truncated.") != string::npos); // Someone running the program has to see why.
+}
+
+TEST(EncodeBufferWithTreeKeepsErrors)
+{
+	string input = TestHarness::MakeText(20000, 37);
+	string treeBuilder((const char*)SampleCodebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE);
+	string output;
+
+	Huffman huffman;
+
+	CHECK(!huffman.EncodeBufferWithTree(input.data(), input.size(), treeBuilder.substr(1), output));
+	CHECK(huffman.GetError() == "Invalid tree file.");
+
+	swap(treeBuilder[508], treeBuilder[509]); // No tree builder lists the higher slot of a pair first.
+
+	CHECK(!huffman.EncodeBufferWithTree(input.data(), input.size(), treeBuilder, output));
+	CHECK(huffman.GetError() == "Invalid tree file.");
+}
+
+// Encodes the given input with the sample codebook's tree file and decodes it again, returning the encoded file
+// and whether it decoded back to the input.
+static bool encodeWithSampleTree(const string& input, const string& name, string& encoded)
+{
+	string inputPath = TestHarness::TempPath(name + ".txt");
+	string treePath = TestHarness::TempPath(name + ".htree");
+	string encodedPath = TestHarness::TempPath(name + ".huf");
+	string decodedPath = TestHarness::TempPath(name + ".out");
+
+	TestHarness::WriteFile(inputPath, input);
+	TestHarness::WriteFile(treePath, string((const char*)SampleCodebook::treeBuilder, HuffmanFormat::TREE_BUILDER_SIZE));
+
+	Huffman huffman;
+
+	huffman.EncodeFileWithTree(inputPath, treePath, encodedPath);
+	huffman.DecodeFile(encodedPath, decodedPath);
+
+	encoded = TestHarness::ReadFile(encodedPath);
+
+	return TestHarness::ReadFile(decodedPath) == input;
+}
+
+TEST(EncodeFileWithTreeStoresWhatTheTreeWouldMakeBigger)
+{
+	string encoded;
+
+	HuffmanFormat::header fileHeader;
+
+	// The sample tree was built from source code, so it codes text well enough,
+	string text = TestHarness::MakeText(100000, 38);
+
+	CHECK(encodeWithSampleTree(text, "tree-text", encoded));
+	CHECK(HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader) && !(fileHeader.flags & HuffmanFormat::FLAG_STORED));
+	CHECK(encoded.size() < text.size());
+
+	// but random bytes, and bytes it gives its longest codes, would come out bigger, so they are stored as is.
+	string random = TestHarness::MakeRandom(100000, 39);
+	string unlikely(100000, '\0');
+
+	for (size_t i = 0; i < unlikely.size(); i++)
+	{
+		unlikely[i] = (char)(0x80 + i % 0x80);
+	}
+
+	const string* inputs[] = { &random, &unlikely };
+
+	for (const string* input : inputs)
+	{
+		CHECK(encodeWithSampleTree(*input, "tree-stored", encoded));
+		CHECK(HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader) && (fileHeader.flags & HuffmanFormat::FLAG_STORED));
+		CHECK(encoded.size() == HuffmanFormat::headerSize(fileHeader) + input->size());
+	}
+}
+
+TEST(EncodeBufferStoresRandomBytes)
+{
+	string random = TestHarness::MakeRandom(100000, 40);
+	string encoded;
+	string decoded;
+
+	Huffman huffman;
+
+	CHECK(huffman.EncodeBuffer(random.data(), random.size(), encoded));
+
+	HuffmanFormat::header fileHeader;
+
+	CHECK(HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader) && (fileHeader.flags & HuffmanFormat::FLAG_STORED));
+	CHECK(encoded.size() == HuffmanFormat::headerSize(fileHeader) + random.size());
+	CHECK(huffman.DecodeBuffer(encoded.data(), encoded.size(), decoded) && decoded == random);
+}
+
+TEST(ChecksumOnlyWhenAskedFor)
+{
+	string input = TestHarness::MakeText(100000, 41);
+	string plain;
+	string verified;
+	string checked;
+	string decoded;
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(input.data(), input.size(), plain);
+
+	huffman.SetVerify(true); // Verifying checks the output against the input while it is written, but doesn't change the file.
+
+	CHECK(huffman.EncodeBuffer(input.data(), input.size(), verified) && huffman.GetError().empty());
+	CHECK(verified == plain);
+
+	huffman.SetChecksum(true); // The checksum is only written with --crc.
+
+	CHECK(huffman.EncodeBuffer(input.data(), input.size(), checked) && huffman.GetError().empty());
+
+	HuffmanFormat::header plainHeader;
+	HuffmanFormat::header checkedHeader;
+
+	CHECK(HuffmanFormat::readHeader(plain.data(), plain.size(), plainHeader) && !(plainHeader.flags & HuffmanFormat::FLAG_CHECKSUM));
+	CHECK(HuffmanFormat::readHeader(checked.data(), checked.size(), checkedHeader) && (checkedHeader.flags & HuffmanFormat::FLAG_CHECKSUM));
+	CHECK(checked.size() == plain.size() + HuffmanFormat::CHECKSUM_SIZE);
+	CHECK(huffman.DecodeBuffer(checked.data(), checked.size(), decoded) && decoded == input);
+}
+
+TEST(BlockFilesRoundTrip)
+{
+	// Text with random bytes in the middle, so blocks use the shared tree, their own, or are stored.
+	string input = TestHarness::MakeText(300000, 42) + TestHarness::MakeRandom(100000, 43) + TestHarness::MakeText(300000, 44);
+	string inputPath = TestHarness::TempPath("blocks.txt");
+	string encodedPath = TestHarness::TempPath("blocks.huf");
+	string decodedPath = TestHarness::TempPath("blocks.out");
+	string encoded;
+	string decoded;
+
+	TestHarness::WriteFile(inputPath, input);
+
+	Huffman huffman;
+
+	huffman.SetBlockSize(Huffman::MIN_BLOCK_SIZE * 4);
+	huffman.SetSeekInterval(1000);
+
+	CHECK(huffman.EncodeBuffer(input.data(), input.size(), encoded));
+
+	for (int i = 0; i < 2; i++) // Counting blocks reuses the same threads every time, which mustn't change the file.
+	{
+		string again;
+
+		CHECK(huffman.EncodeBuffer(input.data(), input.size(), again) && again == encoded);
+	}
+
+	huffman.EncodeFile(inputPath, encodedPath);
+
+	CHECK(TestHarness::ReadFile(encodedPath) == encoded);
+
+	HuffmanFormat::header fileHeader;
+
+	CHECK(HuffmanFormat::readHeader(encoded.data(), encoded.size(), fileHeader) && (fileHeader.flags & HuffmanFormat::FLAG_BLOCKS));
+
+	Huffman decoder;
+
+	CHECK(decoder.DecodeBuffer(encoded.data(), encoded.size(), decoded) && decoded == input);
+
+	decoder.DecodeFile(encodedPath, decodedPath);
+
+	CHECK(TestHarness::ReadFile(decodedPath) == input);
+
+	// Ranges that start in a coded block, span the stored ones, and end in the last block.
+	const unsigned long long offsets[] = { 12345, 290000, input.size() - 5000 };
+
+	for (unsigned long long offset : offsets)
+	{
+		decoder.DecodeRange(encodedPath, decodedPath, offset, 150000);
+
+		CHECK(TestHarness::ReadFile(decodedPath) == input.substr((size_t)offset, 150000));
+	}
+}
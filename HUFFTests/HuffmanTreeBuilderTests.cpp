@@ -0,0 +1,152 @@
+//==============================================================================================
+// File: HuffmanTreeBuilderTests.cpp - HuffmanTreeBuilder tests
+//
+// These tests build trees for alphabets of several sizes, with weights that tie a lot, and
+// make sure the heap combines the same nodes, in the same order, as searching every slot for
+// the two lightest nodes does, so tree builder files stay the same as they always were.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <random>
+
+#include "Huffman.h"
+#include "HuffmanTreeBuilder.h"
+#include "TestHarness.h"
+
+// Returns the combinations that build the tree for the given weights by searching every slot for the two
+// lightest nodes each time, the lower slot first when weights tie, which is how trees were built before the heap.
+static vector<HuffmanTreeBuilder::merge> searchEverySlot(const vector<unsigned long long>& weights)
+{
+	vector<unsigned long long> slots = weights;
+	vector<bool> occupied(weights.size(), true);
+	vector<HuffmanTreeBuilder::merge> merges;
+
+	for (size_t combination = 0; combination + 1 < weights.size(); combination++)
+	{
+		size_t lightest = weights.size();
+		size_t second = weights.size();
+
+		for (size_t i = 0; i < slots.size(); i++)
+		{
+			if (!occupied[i])
+			{
+				continue;
+			}
+
+			if (lightest == weights.size() || slots[i] < slots[lightest])
+			{
+				second = lightest;
+				lightest = i;
+			}
+			else if (second == weights.size() || slots[i] < slots[second])
+			{
+				second = i;
+			}
+		}
+
+		size_t left = min(lightest, second);
+		size_t right = max(lightest, second);
+
+		merges.push_back({ (unsigned int)left, (unsigned int)right });
+
+		slots[left] += slots[right];
+		occupied[right] = false;
+	}
+
+	return merges;
+}
+
+// Returns whether the given combinations are the same ones.
+static bool sameMerges(const vector<HuffmanTreeBuilder::merge>& first, const vector<HuffmanTreeBuilder::merge>& second)
+{
+	if (first.size() != second.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < first.size(); i++)
+	{
+		if (first[i].left != second[i].left || first[i].right != second[i].right)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST(TreeBuilderMatchesSearchingEverySlot)
+{
+	mt19937 generator(70);
+
+	const size_t symbolCounts[] = { 2, 3, 256, 1000, 4096 };
+
+	for (size_t symbolCount : symbolCounts)
+	{
+		// Small weights tie all the time, and some symbols never show up at all.
+		vector<unsigned long long> weights(symbolCount);
+
+		for (size_t i = 0; i < symbolCount; i++)
+		{
+			weights[i] = generator() % 4 == 0 ? 0 : generator() % 20;
+		}
+
+		vector<HuffmanTreeBuilder::merge> merges = HuffmanTreeBuilder::Build(weights.data(), symbolCount);
+
+		CHECK(sameMerges(merges, searchEverySlot(weights)));
+		CHECK(HuffmanTreeBuilder::IsValid(merges, symbolCount));
+
+		// Every symbol gets a code, and the codes use up every bit pattern, so starting from the longest codes,
+		// every two codes of a length pair up into one a bit shorter, until only the empty code of the root is left.
+		vector<unsigned int> lengths = HuffmanTreeBuilder::CodeLengths(merges, symbolCount);
+		vector<unsigned long long> codesOfLength(symbolCount, 0);
+
+		for (unsigned int length : lengths)
+		{
+			CHECK(length >= 1 && length < symbolCount);
+
+			codesOfLength[length]++;
+		}
+
+		for (size_t length = symbolCount - 1; length > 0; length--)
+		{
+			CHECK(codesOfLength[length] % 2 == 0);
+
+			codesOfLength[length - 1] += codesOfLength[length] / 2;
+		}
+
+		CHECK(codesOfLength[0] == 1);
+	}
+}
+
+TEST(TreeBuilderMatchesTreeBuilderFiles)
+{
+	string input = TestHarness::MakeText(100000, 71);
+	string encoded;
+
+	Huffman huffman;
+
+	huffman.EncodeBuffer(input.data(), input.size(), encoded);
+
+	vector<unsigned long long> weights(256, 0);
+
+	for (unsigned char character : input)
+	{
+		weights[character]++;
+	}
+
+	// The bytes of a tree builder file are the slots of each combination, in order.
+	string treeBuilder;
+
+	for (const HuffmanTreeBuilder::merge& combination : HuffmanTreeBuilder::Build(weights.data(), weights.size()))
+	{
+		treeBuilder += (char)combination.left;
+		treeBuilder += (char)combination.right;
+	}
+
+	CHECK(treeBuilder == huffman.GetTreeBuilder());
+}
@@ -0,0 +1,22 @@
+//==============================================================================================
+// Main.cpp - Huffman tests
+//
+// This program runs the tests of the Huffman program, which encode and decode buffers and
+// files and make sure they come back the way they went in, and that corrupt files are
+// rejected. It exits with 0 if every test passed, and 1 otherwise, so it can be run as a
+// step of a build.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include "TestHarness.h"
+
+int main()
+{
+	// This is the entry point of the tests, so we just run every one of them.
+	//
+	return TestHarness::RunAll() == 0 ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+//==============================================================================================
+// File: TestHarness.cpp - Test harness implementation
+// c.f.: TestHarness.h
+//
+// This class runs every registered test, one after the other. The Huffman class prints how
+// long every operation took, so while a test runs, anything written to cout is thrown away,
+// and only the results of the tests are printed. Every run gets its own temporary directory,
+// which is removed once the tests are done.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "TestHarness.h"
+
+// A stream buffer that throws away everything written to it, which cout writes to while a test runs.
+class DiscardBuffer : public streambuf {
+protected:
+	int overflow(int character) override
+	{
+		return character == EOF ? 0 : character; // We accept every character, and do nothing with it.
+	}
+
+	streamsize xsputn(const char*, streamsize count) override
+	{
+		return count;
+	}
+};
+
+// The message of the first failed check of the running test
+static string failureMessage;
+
+TestHarness::registration::registration(const char* name, testfunction test)
+{
+	// The constructor. The TEST macro makes one of these for every test, so
+	// every test is added to the list before main starts.
+	//
+	tests().push_back({ name, test });
+}
+
+int TestHarness::RunAll()
+{
+	// This method runs every registered test in a new temporary directory, and prints
+	// the ones that failed, along with the check that failed. It returns the amount of
+	// tests that failed, so 0 means everything passed.
+	//
+	random_device device; // The temporary directory gets a random name, so two runs at once don't share one.
+
+	filesystem::path directory = filesystem::temp_directory_path() / ("HUFFTests-" + to_string(device()));
+
+	filesystem::create_directories(directory);
+
+	tempDirectory() = directory.string();
+
+	DiscardBuffer discard;
+
+	int failed = 0; // The amount of tests that failed
+
+	for (const test& current : tests()) // Loop through every test,
+	{
+		currentFailed() = false;
+
+		streambuf* previous = cout.rdbuf(&discard); // throw away whatever it prints,
+
+		current.run(); // and run it.
+
+		cout.rdbuf(previous);
+
+		if (currentFailed()) // If one of its checks failed, we say which one.
+		{
+			cout << "FAILED " << current.name << ": " << failureMessage << endl;
+
+			failed++;
+		}
+		else
+		{
+			cout << "passed " << current.name << endl;
+		}
+	}
+
+	cout << tests().size() - failed << " of " << tests().size() << " tests passed." << endl;
+
+	error_code error;
+
+	filesystem::remove_all(directory, error); // We don't need the temporary files anymore.
+
+	return failed;
+}
+
+void TestHarness::Fail(const char* file, int line, const char* condition)
+{
+	// This method records that a check failed, keeping where it was and what it checked.
+	// The test stops right after, so it can only be called once per test.
+	//
+	currentFailed() = true;
+
+	failureMessage = string(file) + ":" + to_string(line) + ": CHECK(" + condition + ")";
+}
+
+string TestHarness::TempPath(const string& name)
+{
+	// This method returns the path of the given file name in the temporary directory.
+	//
+	return (filesystem::path(tempDirectory()) / name).string();
+}
+
+string TestHarness::MakeTempDirectory(const string& name)
+{
+	// This method makes a directory in the temporary directory, removing whatever was
+	// there before, so a test that runs twice starts out the same way both times.
+	//
+	filesystem::path directory = filesystem::path(tempDirectory()) / name;
+
+	error_code error;
+
+	filesystem::remove_all(directory, error);
+
+	filesystem::create_directories(directory);
+
+	return directory.string();
+}
+
+string TestHarness::ReadFile(const string& path)
+{
+	// This method reads the whole given file into a string.
+	//
+	ifstream file(path, ios::binary);
+
+	stringstream contents;
+
+	contents << file.rdbuf();
+
+	return contents.str();
+}
+
+void TestHarness::WriteFile(const string& path, const string& contents)
+{
+	// This method replaces the given file with the given bytes.
+	//
+	ofstream file(path, ios::binary | ios::trunc);
+
+	file.write(contents.data(), contents.size());
+}
+
+string TestHarness::MakeText(size_t size, unsigned int seed)
+{
+	// This method makes text by picking words at random, with a space after each one. The
+	// generator is the Mersenne Twister, whose numbers are the same on every platform, and
+	// we only ever use its raw numbers, so the text is the same everywhere for a seed.
+	//
+	static const char* words[] = { "the", "of", "and", "a", "to", "in", "is", "tree", "code", "huffman",
+		"symbol", "node", "bits", "file", "encode", "decode", "frequency", "table", "leaf", "root" };
+
+	mt19937 generator(seed);
+
+	string text;
+
+	while (text.size() < size)
+	{
+		text += words[generator() % (sizeof(words) / sizeof(words[0]))];
+
+		text += generator() % 16 == 0 ? ".\n" : " ";
+	}
+
+	text.resize(size);
+
+	return text;
+}
+
+string TestHarness::MakeRandom(size_t size, unsigned int seed)
+{
+	// This method makes random bytes, which can't be compressed, the same way MakeText
+	// picks its words.
+	//
+	mt19937 generator(seed);
+
+	string bytes(size, '\0');
+
+	for (size_t i = 0; i < size; i++)
+	{
+		bytes[i] = (char)(generator() & 0xFF);
+	}
+
+	return bytes;
+}
+
+vector<TestHarness::test>& TestHarness::tests()
+{
+	static vector<test> registered;
+
+	return registered;
+}
+
+string& TestHarness::tempDirectory()
+{
+	static string directory;
+
+	return directory;
+}
+
+bool& TestHarness::currentFailed()
+{
+	static bool failed = false;
+
+	return failed;
+}
@@ -0,0 +1,65 @@
+//==============================================================================================
+// File: TestHarness.h - Test harness
+//
+// This class runs the tests of the program. Every test is a function registered with the TEST
+// macro, which checks what it expects with the CHECK macro. A failed check stops its test and
+// is reported, and the rest of the tests still run. The harness also gives the tests a
+// temporary directory for the files they encode and decode, and deterministic inputs, so a
+// failure can be reproduced by running the tests again.
+//
+// Author:     Nicholas Nassar, University of Toledo
+// Class:      EECS 2510-001 Non-Linear Data Structures, Spring 2020
+// Instructor: Dr.Thomas
+// Date:       Mar 17, 2020
+// Copyright:  Copyright 2020 by Nicholas Nassar. All rights reserved.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class TestHarness {
+public:
+	typedef void (*testfunction)(); // A test, which returns early if one of its checks fails
+
+	struct registration {
+		registration(const char* name, testfunction test); // Adds the given test to the ones RunAll runs
+	};
+
+	static int RunAll(); // Runs every registered test, printing the ones that fail, and returns the amount that failed
+	static void Fail(const char* file, int line, const char* condition); // Records that the check of the given condition failed in the running test
+	static string TempPath(const string& name); // Returns the path of a file with the given name in the temporary directory of this run
+	static string MakeTempDirectory(const string& name); // Makes an empty directory with the given name in the temporary directory of this run, and returns its path
+	static string ReadFile(const string& path); // Returns the bytes of the given file, or an empty string if it can't be read
+	static void WriteFile(const string& path, const string& contents); // Replaces the given file with the given bytes
+	static string MakeText(size_t size, unsigned int seed); // Returns the given amount of English-like text, the same every time for the same seed
+	static string MakeRandom(size_t size, unsigned int seed); // Returns the given amount of random bytes, the same every time for the same seed
+private:
+	struct test {
+		const char* name;	// The name of the test, which is the name of its function
+		testfunction run;	// The function that runs it
+	};
+
+	static vector<test>& tests(); // Returns the registered tests, which are kept in a function so they exist before any registration runs
+	static string& tempDirectory(); // Returns the temporary directory of this run, which is empty until RunAll makes it
+	static bool& currentFailed(); // Returns whether a check of the running test has failed
+};
+
+// Defines a test with the given name, registering it before main starts.
+#define TEST(name) \
+	static void name(); \
+	static TestHarness::registration name##Registration(#name, name); \
+	static void name()
+
+// Checks that the given condition is true. If it isn't, the failure is recorded and the test stops.
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			TestHarness::Fail(__FILE__, __LINE__, #condition); \
+			return; \
+		} \
+	} while (false)